@@ -0,0 +1,170 @@
+#ifndef NZS_BIT_GRID_HPP
+#define NZS_BIT_GRID_HPP
+
+#include "cpp_features.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace details
+{
+
+inline std::size_t popcount(std::uint64_t word) NOEXCEPT
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(word);
+#else
+    std::size_t count = 0;
+    while (word != 0)
+    {
+        word &= word - 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// index of the lowest set bit, the word must not be 0
+inline std::size_t lowest_bit(std::uint64_t word) NOEXCEPT
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    std::size_t index = 0;
+    while ((word & 1) == 0)
+    {
+        word >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+// index of the highest set bit, the word must not be 0
+inline std::size_t highest_bit(std::uint64_t word) NOEXCEPT
+{
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(word);
+#else
+    std::size_t index = 0;
+    while (word >>= 1)
+    {
+        ++index;
+    }
+    return index;
+#endif
+}
+
+// Zobrist-style key of a word of cells at the index of the grid: the hash of a
+// grid is the XOR of the keys of its words, so a change of a word is an update
+// of the hash by key(old) ^ key(new); the dead words have no key
+inline std::uint64_t word_key(std::size_t index, std::uint64_t word) NOEXCEPT
+{
+    // splitmix64 finalizer over the cells and the position, masked without a branch
+    std::uint64_t key = word ^ (static_cast<std::uint64_t>(index) * 0x9e3779b97f4a7c15ull);
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+    return (key ^ (key >> 31)) & (0 - static_cast<std::uint64_t>(word != 0));
+}
+
+} // details
+
+// bit-packed cell storage, every row is a contiguous run of 64-bit words
+// and the cell (x, y) is bit x % 64 of word x / 64 in row y
+class BitGrid
+{
+public:
+    using word_type = std::uint64_t;
+
+    static const std::size_t word_bits = 64;
+
+    // create a width_X_height size grid where every cells is dead
+    BitGrid(std::size_t width, std::size_t height);
+
+    inline bool get(std::size_t x, std::size_t y) const NOEXCEPT
+    {
+        return (row(y)[x / word_bits] >> (x % word_bits)) & 1;
+    }
+
+    inline void set(std::size_t x, std::size_t y, bool alive) NOEXCEPT
+    {
+        word_type &word = row(y)[x / word_bits];
+        word_type mask = word_type(1) << (x % word_bits);
+        word = alive ? (word | mask) : (word & ~mask);
+    }
+
+    inline word_type *row(std::size_t y) NOEXCEPT
+    {
+        return words_.data() + y * words_per_row_;
+    }
+
+    inline const word_type *row(std::size_t y) const NOEXCEPT
+    {
+        return words_.data() + y * words_per_row_;
+    }
+
+    // an always empty row, the neighbor of the border rows in a bounded grid
+    inline const word_type *zero_row() const NOEXCEPT
+    {
+        return row(height_);
+    }
+
+    // valid bits of the last word in every row
+    inline word_type tail_mask() const NOEXCEPT
+    {
+        return width_ % word_bits == 0 ? ~word_type(0) :
+               (word_type(1) << (width_ % word_bits)) - 1;
+    }
+
+    inline std::size_t get_width() const NOEXCEPT
+    {
+        return width_;
+    }
+
+    inline std::size_t get_height() const NOEXCEPT
+    {
+        return height_;
+    }
+
+    inline std::size_t words_per_row() const NOEXCEPT
+    {
+        return words_per_row_;
+    }
+
+    // kill all cells
+    void clear() NOEXCEPT;
+
+    // change the size and keep the overlapping cells
+    void resize(std::size_t width, std::size_t height);
+
+    // number of alive cells
+    std::size_t count() const NOEXCEPT;
+
+    // number of alive cells in the rows [first_row, last_row)
+    std::size_t count(std::size_t first_row, std::size_t last_row) const NOEXCEPT;
+
+    // number of alive cells in the words [first_word, last_word) of the rows [first_row, last_row)
+    std::size_t count(std::size_t first_row, std::size_t last_row,
+                      std::size_t first_word, std::size_t last_word) const NOEXCEPT;
+
+    void swap(BitGrid &other) NOEXCEPT;
+
+private:
+    std::size_t width_;
+    std::size_t height_;
+    std::size_t words_per_row_;
+    std::vector<word_type> words_;
+};
+
+} // gol
+
+} // nzs
+
+#endif // NZS_BIT_GRID_HPP
@@ -28,7 +28,7 @@ public:
     BrushTool();
 
     // add a new brush
-    void add(Brush brush);
+    void add(Brush brush, std::string name = std::string());
 
     // move to the next brush
     void next() NOEXCEPT;
@@ -42,6 +42,9 @@ public:
     // get the actual brush
     const Brush &get() const;
 
+    // the name of the actual brush, the comment above it in the brush file
+    const std::string &name() const;
+
     // return the number of brushes
     inline std::size_t size() const NOEXCEPT
     {
@@ -52,6 +55,7 @@ public:
     inline void clear() NOEXCEPT
     {
         brushs_.clear();
+        names_.clear();
         add({});
     }
 
@@ -61,6 +65,7 @@ public:
 private:
     int brush_id_;
     std::vector<Brush> brushs_;
+    std::vector<std::string> names_;
 
     inline bool good_id(int id) const NOEXCEPT
     {
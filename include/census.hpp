@@ -0,0 +1,78 @@
+#ifndef NZS_CENSUS_HPP
+#define NZS_CENSUS_HPP
+
+#include "bit_grid.hpp"
+#include "brush_tool.hpp"
+#include "cpp_features.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+// the same shape in every rotation, reflection and position gives the same code:
+// "<width>x<height>:" and the rows of the smallest of the 8 orientations, every row
+// as hex digits of 4 cells from the left, separated by '/' (a block is "2x2:3/3")
+std::string canonical_code(std::vector<Position> cells);
+
+// the known objects by the codes of their phases
+class ObjectLibrary
+{
+public:
+    // add the pattern and the phases of its cycle under the name: the pattern is
+    // run until a shape repeats (a moving one included), so a pattern which
+    // settles into an oscillator within 64 generations names the oscillator too
+    void add(const std::string &name, const Brush &cells);
+
+    // add the brushes of a brush file, the comment line before a brush is its name;
+    // return false if the file cannot be read
+    bool load_brushes(const std::string &file_path);
+
+    // name of the object, empty if it is unknown
+    const std::string &find(const std::string &code) const;
+
+    inline std::size_t size() const NOEXCEPT
+    {
+        return names_.size();
+    }
+
+private:
+    std::unordered_map<std::string, std::string> names_;
+};
+
+// the objects of one kind on the board
+struct CensusEntry
+{
+    // name in the library or the code of an unknown object
+    std::string name;
+    std::string code;
+    std::size_t cells;
+    std::size_t count;
+    bool known;
+};
+
+struct Census
+{
+    // the most common objects first
+    std::vector<CensusEntry> entries;
+    std::size_t objects;
+};
+
+// split the grid into objects (the 8-connected groups of alive cells) and count
+// them by their canonical code; the rows are scanned as runs of alive cells and
+// the touching runs are joined, so the work follows the words and the runs of
+// the grid, only the cells of the objects are visited one by one; the objects
+// are not joined across the border of a wrapping grid
+Census take_census(const BitGrid &grid, const ObjectLibrary &library);
+
+} // gol
+
+} // nzs
+
+#endif // NZS_CENSUS_HPP
@@ -0,0 +1,153 @@
+#ifndef NZS_CHECKPOINT_HPP
+#define NZS_CHECKPOINT_HPP
+
+#include "game_of_life.hpp"
+#include "bit_grid.hpp"
+#include "rule.hpp"
+#include "cpp_features.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <deque>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+// the state of a GameOfLife which survives a restart
+struct Checkpoint
+{
+    BitGrid grid;
+    std::size_t generation;
+    bool bounded;
+    Rule rule;
+};
+
+// copy the state of the game, the copy can be written on an other thread
+Checkpoint make_checkpoint(const GameOfLife &game);
+
+// replace the state of the game with the checkpoint
+void restore(GameOfLife &game, Checkpoint checkpoint);
+
+// write the checkpoint: a 64 byte header, the rows of the grid as little endian
+// 64-bit words (the runs of zero words are left out if compressed) and a checksum;
+// the file is replaced only when it is complete and synced to the disk, return
+// false if it cannot be written; the sequence number orders the automatic
+// checkpoints (see latest_checkpoint)
+bool save_checkpoint(const std::string &file_path, const Checkpoint &checkpoint,
+                     bool compressed = true, std::uint32_t sequence = 0);
+
+// read a checkpoint through a memory mapping of the file,
+// return false if the file cannot be read or it is broken
+bool load_checkpoint(const std::string &file_path, Checkpoint &checkpoint);
+
+// writes the checkpoints on its own thread, so the simulation does not wait for the disk
+class CheckpointWriter
+{
+public:
+    CheckpointWriter();
+
+    // write the queued checkpoints and stop the thread
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter &) = delete;
+    CheckpointWriter &operator=(const CheckpointWriter &) = delete;
+
+    // queue the checkpoint, the writer owns it from now
+    void write(std::string file_path, Checkpoint checkpoint, bool compressed = true,
+               std::uint32_t sequence = 0);
+
+    // wait until the queued checkpoints are written
+    void flush();
+
+    // number of the checkpoints which are queued or being written
+    std::size_t pending();
+
+private:
+    struct Job
+    {
+        std::string file_path;
+        Checkpoint checkpoint;
+        bool compressed;
+        std::uint32_t sequence;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::deque<Job> jobs_;
+    std::size_t busy_;
+    bool stop_;
+    std::thread thread_;
+
+    void loop();
+};
+
+// when and where the automatic checkpoints are written
+struct CheckpointPolicy
+{
+    CheckpointPolicy() :
+        generations(0),
+        seconds(0),
+        keep(3),
+        prefix("./autosave")
+    {
+    }
+
+    // write a checkpoint after this many generations, 0 = never
+    std::size_t generations;
+    // write a checkpoint after this much time while running, 0 = never
+    std::chrono::seconds seconds;
+    // the checkpoints go to the <prefix>.<slot>.gol files in turn, so only
+    // the last keep checkpoints use the disk
+    std::size_t keep;
+    std::string prefix;
+
+    inline bool enabled() const NOEXCEPT
+    {
+        return (generations != 0 || seconds.count() != 0) && keep != 0;
+    }
+};
+
+// file of the last written checkpoint of the policy which loads without an error,
+// empty if there is none
+std::string latest_checkpoint(const CheckpointPolicy &policy);
+
+// writes the checkpoints of the policy in the background
+class AutoCheckpoint
+{
+public:
+    // continue after the newest slot of an earlier run
+    explicit AutoCheckpoint(const CheckpointPolicy &policy);
+
+    // call after the steps: if a checkpoint is due the game is copied and written
+    // on the writer thread, it is postponed while the previous one is being written
+    void update(const GameOfLife &game);
+
+private:
+    using clock_type = std::chrono::steady_clock;
+
+    CheckpointPolicy policy_;
+    std::size_t slot_;
+    // written into the next checkpoint, one more than the newest one on the disk
+    std::uint32_t sequence_;
+    // the first update only starts the counting
+    bool started_;
+    std::size_t last_generation_;
+    clock_type::time_point last_time_;
+    CheckpointWriter writer_;
+};
+
+} // gol
+
+} // nzs
+
+#endif // NZS_CHECKPOINT_HPP
@@ -1,11 +1,18 @@
-#ifndef _MSC_VER
-#define NOEXCEPT noexcept
-#else
-#define NOEXCEPT
-#endif
-
-#ifndef _MSC_VER
-#define CONSTEXPR constexpr
-#else
-#define CONSTEXPR
+#ifndef _MSC_VER
+#define NOEXCEPT noexcept
+#else
+#define NOEXCEPT
+#endif
+
+#ifndef _MSC_VER
+#define CONSTEXPR constexpr
+#else
+#define CONSTEXPR
+#endif
+
+// only for the plain types: the thread local storage of MSVC does not run constructors
+#ifndef _MSC_VER
+#define THREAD_LOCAL thread_local
+#else
+#define THREAD_LOCAL __declspec(thread)
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <string>
 
 namespace nzs
 {
@@ -45,6 +46,70 @@ inline void draw_grid(int row, int column)
     glEnd();
 }
 
+// rows of a 3x5 glyph from the top, 4 = left column, 1 = right column;
+// 0 for a character without a glyph
+inline const unsigned char *glyph(char c)
+{
+    struct Glyph
+    {
+        char c;
+        unsigned char rows[5];
+    };
+    static const Glyph glyphs[] =
+    {
+        {'0', {7, 5, 5, 5, 7}}, {'1', {2, 6, 2, 2, 7}}, {'2', {7, 1, 7, 4, 7}},
+        {'3', {7, 1, 3, 1, 7}}, {'4', {5, 5, 7, 1, 1}}, {'5', {7, 4, 7, 1, 7}},
+        {'6', {7, 4, 7, 5, 7}}, {'7', {7, 1, 1, 2, 2}}, {'8', {7, 5, 7, 5, 7}},
+        {'9', {7, 5, 7, 1, 7}}, {'A', {2, 5, 7, 5, 5}}, {'B', {6, 5, 6, 5, 6}},
+        {'C', {3, 4, 4, 4, 3}}, {'D', {6, 5, 5, 5, 6}}, {'E', {7, 4, 6, 4, 7}},
+        {'F', {7, 4, 6, 4, 4}}, {'G', {3, 4, 5, 5, 3}}, {'H', {5, 5, 7, 5, 5}},
+        {'I', {7, 2, 2, 2, 7}}, {'J', {1, 1, 1, 5, 2}}, {'K', {5, 5, 6, 5, 5}},
+        {'L', {4, 4, 4, 4, 7}}, {'M', {5, 7, 7, 5, 5}}, {'N', {6, 5, 5, 5, 5}},
+        {'O', {2, 5, 5, 5, 2}}, {'P', {6, 5, 6, 4, 4}}, {'Q', {2, 5, 5, 6, 3}},
+        {'R', {6, 5, 6, 5, 5}}, {'S', {3, 4, 2, 1, 6}}, {'T', {7, 2, 2, 2, 2}},
+        {'U', {5, 5, 5, 5, 7}}, {'V', {5, 5, 5, 5, 2}}, {'W', {5, 5, 7, 7, 5}},
+        {'X', {5, 5, 2, 5, 5}}, {'Y', {5, 5, 2, 2, 2}}, {'Z', {7, 1, 2, 4, 7}},
+        {'.', {0, 0, 0, 0, 2}}, {':', {0, 2, 0, 2, 0}}, {'-', {0, 0, 7, 0, 0}},
+        {'/', {1, 1, 2, 4, 4}}
+    };
+
+    if (c >= 'a' && c <= 'z')
+    {
+        c = c - 'a' + 'A';
+    }
+    for (const auto &g : glyphs)
+    {
+        if (g.c == c)
+        {
+            return g.rows;
+        }
+    }
+    return nullptr;
+}
+
+// draw the text from the top left corner, a glyph pixel is pixel_width x
+// pixel_height and a character takes 4 x 6 glyph pixels
+inline void draw_text(float x, float y, float pixel_width, float pixel_height,
+                      const std::string &text)
+{
+    for (char c : text)
+    {
+        const unsigned char *rows = glyph(c);
+        for (int row = 0; rows && row < 5; ++row)
+        {
+            for (int column = 0; column < 3; ++column)
+            {
+                if (rows[row] & (4 >> column))
+                {
+                    draw_quad(x + column * pixel_width, y + row * pixel_height,
+                              pixel_width, pixel_height);
+                }
+            }
+        }
+        x += 4 * pixel_width;
+    }
+}
+
 } // details
 
 } // gol
@@ -1,10 +1,14 @@
 #ifndef NZS_GAME_GUI_HPP
 #define NZS_GAME_GUI_HPP
 
-#include "game_of_life.hpp"
+#include "simulation.hpp"
+#include "checkpoint.hpp"
+#include "grid_renderer.hpp"
 #include "draw_function.hpp"
 #include "brush_tool.hpp"
 #include "callback_system.hpp"
+#include "timing.hpp"
+#include "trace.hpp"
 
 #include <GLFW/glfw3.h>
 
@@ -12,6 +16,7 @@
 #include <memory>
 #include <iostream>
 #include <string>
+#include <vector>
 #include <chrono>
 
 namespace nzs
@@ -24,7 +29,11 @@ class GameGui
 {
 public:
     GameGui(std::size_t window_width, std::size_t window_height,
-            std::size_t row, std::size_t column, bool full_screen);
+            std::size_t row, std::size_t column, bool full_screen,
+            std::size_t threads = 1, const Rule &rule = Rule(),
+            const std::string &pattern = std::string(),
+            const std::vector<std::string> &brush_files = std::vector<std::string>(),
+            const CheckpointPolicy &autosave = CheckpointPolicy());
 
     // start the simulation
     void run();
@@ -32,22 +41,40 @@ public:
 private:
     using WindowUptr = std::unique_ptr<GLFWwindow, std::function<void(GLFWwindow *)> >;
     WindowUptr window_;
-    GameOfLife game_table_;
+    // belongs to the OpenGL context of the window
+    std::unique_ptr<GridRenderer> renderer_;
+    // used by the simulation thread, so it is destroyed after the simulation
+    CheckpointWriter checkpoints_;
+    Simulation simulation_;
+    // the cells of the current frame
+    const Simulation::Snapshot *snapshot_;
     BrushTool brushs_;
     double window_width_;
     double window_height_;
     bool full_screen_;
     std::chrono::milliseconds wait_next_iter_;
     bool call_next_iter_;
+    bool max_speed_;
+    // generations/s in the window title
+    double shown_rate_;
     bool first_left_click_is_alive_;
+    // the timing overlay shows the times of the last half second
+    bool show_timers_;
+    std::vector<TimerCounts> timer_counts_;
+    std::vector<TimerSummary> shown_timers_;
+    double shown_seconds_;
+    std::chrono::steady_clock::time_point timers_time_;
     friend class details::Event<GameGui>;
 
     bool init();
     void update();
     void draw();
+    // the frame phases as text and bars in the top left corner
+    void draw_timers();
+    void update_timers();
 
     void mouse_button_callback(GLFWwindow *, int button, int action, int mods);
-    void keyboard_callback(GLFWwindow *, int key, int, int action, int);
+    void keyboard_callback(GLFWwindow *, int key, int, int action, int mods);
     void scroll_callback(GLFWwindow *, double , double yoffset);
     void frame_buffer_callback(GLFWwindow *, int width, int height);
 
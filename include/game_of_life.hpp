@@ -2,10 +2,16 @@
 #define NZS_GAME_OF_LIFE_HPP
 
 #include "position.hpp"
+#include "bit_grid.hpp"
+#include "rule.hpp"
+#include "thread_pool.hpp"
+#include "census.hpp"
 #include "cpp_features.hpp"
 
 #include <cstddef>
+#include <cstdint>
 #include <vector>
+#include <memory>
 #include <algorithm>
 
 namespace nzs
@@ -14,14 +20,34 @@ namespace nzs
 namespace gol
 {
 
+// algorithm used by next()
+enum class Engine
+{
+    // cell by cell neighbor counting
+    reference,
+    // 64 cells per word with bitwise adders
+    bitwise
+};
+
+// work done by the last next() call, summed over its generations
+struct StepStats
+{
+    // tiles of the grid, summed over the generations
+    std::size_t tiles;
+    // tiles which were recalculated, the rest did not change
+    std::size_t stepped_tiles;
+
+    inline double skip_ratio() const NOEXCEPT
+    {
+        return tiles == 0 ? 0.0 : 1.0 - static_cast<double>(stepped_tiles) / tiles;
+    }
+};
+
 class GameOfLife
 {
 public:
-    using row_type = std::vector<bool>;
-    using grid_type = std::vector<row_type>;
-
     // create a width_X_height size grid where every cells is dead
-    GameOfLife(std::size_t width, std::size_t height);
+    GameOfLife(std::size_t width, std::size_t height, Engine engine = Engine::bitwise);
 
     // kill the cell
     void kill(const Position &pos);
@@ -40,6 +66,9 @@ public:
 
     void resize(std::size_t width, std::size_t height);
 
+    // replace the cells and the generation, the size of the game follows the grid
+    void restore(BitGrid grid, std::size_t generation);
+
     bool is_alive(const Position &pos) const;
 
     inline std::size_t get_width() const NOEXCEPT
@@ -62,9 +91,62 @@ public:
         return population_;
     }
 
+    // the objects of the current generation by kind, see take_census
+    inline Census census(const ObjectLibrary &library) const
+    {
+        return take_census(grid_, library);
+    }
+
+    // changes whenever the cells change
+    inline std::size_t version() const NOEXCEPT
+    {
+        return version_;
+    }
+
+    // call f(first_row, last_row, first_word, last_word) for the tiles of the grid
+    // whose cells changed after the version, so a copy of the grid taken at that
+    // version is updated without comparing the unchanged tiles
+    template<class F>
+    void changed_tiles(std::size_t version, F f) const
+    {
+        for (std::size_t tile_y = 0; tile_y < tiles_y_; ++tile_y)
+        {
+            for (std::size_t tile_x = 0; tile_x < tiles_x_; ++tile_x)
+            {
+                if (tile_version_[tile_y * tiles_x_ + tile_x] > version)
+                {
+                    std::size_t first_row = tile_y * tile_rows;
+                    std::size_t first_word = tile_x * tile_words;
+                    f(first_row, std::min(first_row + tile_rows, height_),
+                      first_word, std::min(first_word + tile_words, grid_.words_per_row()));
+                }
+            }
+        }
+    }
+
+    inline const StepStats &stats() const NOEXCEPT
+    {
+        return stats_;
+    }
+
+    // 64-bit hash of the cells, equal grids have equal hashes
+    inline std::uint64_t hash() const NOEXCEPT
+    {
+        return hash_;
+    }
+
+    // the board repeats itself since period() generations: 1 for a static board,
+    // 0 until a repetition is found; the edits and the rule changes restart the search
+    inline std::size_t period() const NOEXCEPT
+    {
+        return period_;
+    }
+
     inline void toggle_boundary() NOEXCEPT
     {
         bounded_ = !bounded_;
+        mark_all_changed();
+        forget_states();
     }
 
     inline bool is_bounded() const NOEXCEPT
@@ -72,18 +154,122 @@ public:
         return bounded_;
     }
 
-    inline const row_type &operator[](int index) const
+    inline void set_engine(Engine engine) NOEXCEPT
     {
-        return grid_[index];
+        engine_ = engine;
+        mark_all_changed();
+    }
+
+    inline Engine get_engine() const NOEXCEPT
+    {
+        return engine_;
+    }
+
+    inline void set_rule(const Rule &rule)
+    {
+        rule_ = rule;
+        mark_all_changed();
+        forget_states();
+    }
+
+    inline const Rule &get_rule() const NOEXCEPT
+    {
+        return rule_;
+    }
+
+    // step the bitwise engine on this many threads (0 = one per core)
+    void set_threads(std::size_t threads);
+
+    inline std::size_t get_threads() const NOEXCEPT
+    {
+        return pool_ ? pool_->size() : 1;
+    }
+
+    // the cells of the current generation
+    inline const BitGrid &grid() const NOEXCEPT
+    {
+        return grid_;
     }
 
 private:
+    // the bitwise engine skips the tiles whose neighborhood did not change
+    static const std::size_t tile_rows = 32;
+    static const std::size_t tile_words = 8;
+    // size of the hash -> generation table, the longer periods may be missed
+    static const std::size_t seen_size = 1024;
+    static const std::size_t seen_probes = 4;
+
+    struct SeenState
+    {
+        std::uint64_t hash;
+        std::size_t generation;
+        // the entries of an older epoch are empty
+        std::size_t epoch;
+    };
+
     std::size_t width_;
     std::size_t height_;
     std::size_t generation_;
     std::size_t population_;
+    std::size_t version_;
     bool bounded_;
-    grid_type grid_;
+    Engine engine_;
+    Rule rule_;
+    BitGrid grid_;
+    // the next generation is written here by the bitwise engine
+    BitGrid back_grid_;
+    std::unique_ptr<ThreadPool> pool_;
+    std::size_t tiles_x_;
+    std::size_t tiles_y_;
+    // tiles changed by the last step or by an edit since then
+    std::vector<char> changed_;
+    // tiles to recalculate in the current step
+    std::vector<char> active_;
+    // the version in which the cells of the tile changed the last time
+    std::vector<std::size_t> tile_version_;
+    std::vector<std::size_t> tile_population_;
+    // XOR of the word keys of the tiles and of the grid
+    std::vector<std::uint64_t> tile_hash_;
+    std::uint64_t hash_;
+    // the generations of the recent states by their hash
+    std::vector<SeenState> seen_;
+    std::size_t epoch_;
+    std::size_t period_;
+    StepStats stats_;
+
+    void next_reference();
+    void next_bitwise();
+
+    void reset_tiles();
+
+    // hash of the words of a tile
+    std::uint64_t tile_hash(const BitGrid &grid, std::size_t tile_x, std::size_t tile_y) const NOEXCEPT;
+
+    // update the hash for an edited word
+    void rehash_word(std::size_t x, std::size_t y, BitGrid::word_type old_word) NOEXCEPT;
+
+    // look for the hash of the current generation among the earlier ones
+    void remember_state();
+
+    inline void forget_states() NOEXCEPT
+    {
+        ++epoch_;
+        period_ = 0;
+    }
+
+    // move the changed flags to the active flags of the tiles and their neighbors,
+    // return the number of active tiles
+    std::size_t mark_active_tiles();
+
+    inline void mark_all_changed() NOEXCEPT
+    {
+        std::fill(changed_.begin(), changed_.end(), 1);
+    }
+
+    inline std::size_t tile_of(const Position &pos) const NOEXCEPT
+    {
+        return (pos.get_y() / tile_rows) * tiles_x_ + pos.get_x() / (tile_words * BitGrid::word_bits);
+    }
 
     std::size_t get_alive_neighbors(const Position &pos);
     void boundary_correction(Position &pos) NOEXCEPT;
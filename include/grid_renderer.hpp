@@ -0,0 +1,53 @@
+#ifndef NZS_GRID_RENDERER_HPP
+#define NZS_GRID_RENDERER_HPP
+
+#include "bit_grid.hpp"
+#include "cpp_features.hpp"
+
+#include <GLFW/glfw3.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+// draws the cells and the grid lines as one quad over [0, 1] x [0, 1]: the cells
+// are uploaded to a texture (one texel per cell) and a shader colors the pixels
+class GridRenderer
+{
+public:
+    // needs the current OpenGL context, the shaders need OpenGL 2.0
+    GridRenderer();
+    ~GridRenderer();
+
+    GridRenderer(const GridRenderer &) = delete;
+    GridRenderer &operator=(const GridRenderer &) = delete;
+
+    // upload the cells if the version changed since the last call and draw them,
+    // return false if the grid cannot be drawn this way (no shaders or too large grid)
+    bool draw(const BitGrid &grid, std::size_t version);
+
+private:
+    bool supported_;
+    GLuint program_;
+    GLuint texture_;
+    GLint max_texture_size_;
+    std::size_t width_;
+    std::size_t height_;
+    std::size_t version_;
+    std::vector<std::uint8_t> texels_;
+
+    bool init();
+    void upload(const BitGrid &grid);
+};
+
+} // gol
+
+} // nzs
+
+#endif // NZS_GRID_RENDERER_HPP
@@ -0,0 +1,163 @@
+#ifndef NZS_HASH_LIFE_HPP
+#define NZS_HASH_LIFE_HPP
+
+#include "position.hpp"
+#include "bit_grid.hpp"
+#include "rule.hpp"
+#include "cpp_features.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+// HashLife (memoized quadtree) engine on an unbounded plane,
+// it advances 2^k generations with a single jump(k) call; B3/S23 only
+class HashLife
+{
+public:
+    // the node cache is collected between jumps when it is half full, and a jump
+    // never grows it above max_nodes (the nodes of a loaded pattern are all kept)
+    explicit HashLife(std::size_t max_nodes = std::size_t(1) << 22);
+
+    // the rules the engine can calculate (B3/S23)
+    static bool supports(const Rule &rule) NOEXCEPT;
+
+    // kill the cell
+    void kill(const Position &pos);
+
+    // mark the cell alive
+    void born(const Position &pos);
+
+    // flip the life
+    void flip(const Position &pos);
+
+    // calculate the next iteration
+    void next(std::uint64_t iteration = 1);
+
+    // advance 2^power generations at once; when the node cache fills up the jump
+    // is restarted after a collection as two half jumps, throws std::length_error
+    // if not even one generation fits
+    void jump(unsigned power);
+
+    // kill all cells
+    void clear();
+
+    bool is_alive(const Position &pos) const;
+
+    inline std::uint64_t generation() const NOEXCEPT
+    {
+        return generation_;
+    }
+
+    inline void set_generation(std::uint64_t generation) NOEXCEPT
+    {
+        generation_ = generation;
+    }
+
+    std::uint64_t population() const NOEXCEPT;
+
+    // number of nodes in the cache
+    inline std::size_t node_count() const NOEXCEPT
+    {
+        return live_nodes_;
+    }
+
+    inline std::size_t get_max_nodes() const NOEXCEPT
+    {
+        return max_nodes_;
+    }
+
+    // free every node which is not part of the current pattern
+    void collect_garbage();
+
+    // replace the pattern with the cells of the grid, (0, 0) of the grid goes to offset
+    void set_cells(const BitGrid &grid, const Position64 &offset);
+
+    // append the alive cells, the empty nodes are skipped
+    void get_cells(std::vector<Position64> &cells) const;
+
+    // read a macrocell (.mc) file of Golly: one line per unique node, so the time
+    // depends on the number of nodes instead of the cells; the rule of the "#R"
+    // line is returned, return false if the input is broken
+    bool read_macrocell(std::istream &in, std::string &rule);
+
+    // write the pattern and the generation in macrocell format
+    void write_macrocell(std::ostream &out, const std::string &rule = "B3/S23") const;
+
+private:
+    using node_id = std::uint32_t;
+
+    struct Node
+    {
+        node_id nw;
+        node_id ne;
+        node_id sw;
+        node_id se;
+        // next node in the hash chain or in the free list
+        node_id next;
+        // memoized successor, advanced 2^result_step generations
+        node_id result;
+        std::uint64_t population;
+        std::uint8_t level;
+        std::uint8_t result_step;
+    };
+
+    static const node_id none = ~node_id(0);
+    static const node_id dead = 0;
+    static const node_id alive = 1;
+
+    std::size_t max_nodes_;
+    std::size_t live_nodes_;
+    std::vector<Node> nodes_;
+    std::vector<node_id> buckets_;
+    node_id free_list_;
+    // the empty node of every level
+    std::vector<node_id> empty_;
+    // the root covers [-2^(level - 1), 2^(level - 1)) on both axes
+    node_id root_;
+    std::uint64_t generation_;
+    // join() throws std::length_error at max_nodes_ while this is set
+    bool stepping_;
+
+    // jump without the recovery of a full cache
+    void advance(unsigned power);
+
+    node_id join(node_id nw, node_id ne, node_id sw, node_id se);
+    node_id empty(unsigned level);
+    node_id centre(node_id node);
+    node_id successor(node_id node, unsigned step);
+    node_id successor_level_2(node_id node);
+
+    // level 3 node of 8x8 cells, bit y * 8 + x
+    node_id leaf(std::uint64_t cells);
+    std::uint64_t leaf_cells(node_id node) const;
+
+    node_id build(const BitGrid &grid, unsigned level, std::int64_t x, std::int64_t y);
+    void get_cells(node_id node, std::int64_t x, std::int64_t y,
+                   std::vector<Position64> &cells) const;
+
+    // grow the root with an empty border, the pattern stays in the middle
+    void expand();
+
+    // true if the cell is inside the root
+    bool contains(const Position &pos) const NOEXCEPT;
+    void set_cell(const Position &pos, bool alive);
+    node_id set_cell(node_id node, std::int64_t x, std::int64_t y, bool alive);
+
+    void rehash(std::size_t bucket_count);
+    std::size_t bucket_of(node_id nw, node_id ne, node_id sw, node_id se) const NOEXCEPT;
+};
+
+} // gol
+
+} // nzs
+
+#endif // NZS_HASH_LIFE_HPP
@@ -0,0 +1,85 @@
+#ifndef NZS_HISTORY_HPP
+#define NZS_HISTORY_HPP
+
+#include "game_of_life.hpp"
+#include "bit_grid.hpp"
+#include "cpp_features.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+// the earlier generations of a game for rewinding: every entry holds the words
+// which differ from the next recorded state (XOR delta), every keyframe_interval-th
+// entry holds every alive word of its state instead, so the memory follows the
+// changes and not the size of the grid; the oldest entries are dropped to stay
+// under max_bytes
+class History
+{
+public:
+    explicit History(std::size_t max_bytes = std::size_t(64) << 20,
+                     std::size_t keyframe_interval = 256);
+
+    // record the state of the game if it changed since the last call, only the
+    // tiles changed since then are compared (see GameOfLife::changed_tiles)
+    void push(const GameOfLife &game);
+
+    // go back at most steps recorded states, return false if there is none;
+    // the changes of the game since the last push are dropped
+    bool rewind(std::size_t steps, GameOfLife &game);
+
+    // forget every recorded state
+    void clear();
+
+    // number of the states which can be restored
+    inline std::size_t size() const NOEXCEPT
+    {
+        return entries_.size();
+    }
+
+    // memory used by the entries
+    inline std::size_t bytes() const NOEXCEPT
+    {
+        return bytes_;
+    }
+
+private:
+    struct Entry
+    {
+        std::size_t generation;
+        std::size_t width;
+        std::size_t height;
+        bool keyframe;
+        // index of the changed (alive for a keyframe) words and their XOR (value)
+        std::vector<std::uint32_t> positions;
+        std::vector<BitGrid::word_type> words;
+    };
+
+    std::size_t max_bytes_;
+    std::size_t keyframe_interval_;
+    std::deque<Entry> entries_;
+    std::size_t bytes_;
+    // entries pushed since the last keyframe
+    std::size_t since_keyframe_;
+
+    // the last recorded state
+    bool recorded_;
+    BitGrid current_;
+    std::size_t generation_;
+    std::size_t version_;
+
+    void add(Entry entry);
+};
+
+} // gol
+
+} // nzs
+
+#endif // NZS_HISTORY_HPP
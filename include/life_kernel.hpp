@@ -0,0 +1,79 @@
+#ifndef NZS_LIFE_KERNEL_HPP
+#define NZS_LIFE_KERNEL_HPP
+
+#include "bit_grid.hpp"
+#include "rule.hpp"
+#include "cpp_features.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NZS_X86_SIMD
+#endif
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace details
+{
+
+using word_type = BitGrid::word_type;
+
+// instruction sets of the stepping kernel
+enum class Simd
+{
+    scalar,
+    sse2,
+    avx2
+};
+
+// the best instruction set of this CPU, detected once at startup
+Simd simd_support() NOEXCEPT;
+
+// the instruction set used by step_bitwise()
+Simd simd() NOEXCEPT;
+
+// use a given instruction set, falls back to the best supported one
+void set_simd(Simd simd) NOEXCEPT;
+
+const char *simd_name(Simd simd) NOEXCEPT;
+
+// steps the words [first, last) of a row where the words first - 1 and last exist,
+// ORs the changed bits into changed and adds the new alive cells to population;
+// returns the first word which is not processed (the remainder is left to the caller)
+using span_function = std::size_t (*)(const word_type *up, const word_type *mid,
+                                      const word_type *down, word_type *out,
+                                      std::size_t first, std::size_t last,
+                                      word_type &changed, std::size_t &population);
+
+// the SSE2/AVX2 span of the rule, nullptr if the rule has no kernel of its own
+span_function span_sse2(const Rule &rule) NOEXCEPT;
+span_function span_avx2(const Rule &rule) NOEXCEPT;
+
+struct StepResult
+{
+    // alive cells of the calculated part
+    std::size_t population;
+    // true if any of the calculated cells changed
+    bool changed;
+};
+
+// calculate the words [first_word, last_word) of the rows [first_row, last_row)
+// of the next generation of src into dst (same size grids), the rest of dst is
+// untouched; the common rules have compiled kernels, the rest uses the lookup
+// table of the rule
+StepResult step_bitwise(const BitGrid &src, BitGrid &dst, const Rule &rule, bool bounded,
+                        std::size_t first_row, std::size_t last_row,
+                        std::size_t first_word, std::size_t last_word) NOEXCEPT;
+
+} // details
+
+} // gol
+
+} // nzs
+
+#endif // NZS_LIFE_KERNEL_HPP
@@ -0,0 +1,199 @@
+#ifndef NZS_LIFE_LOGIC_HPP
+#define NZS_LIFE_LOGIC_HPP
+
+// Word type independent Life logic shared by the scalar and SIMD kernels.
+// Only templates live here: the SIMD translation units include this file
+// after switching the target instruction set, so every instantiation gets
+// compiled for the instruction set of the word type it is used with.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace details
+{
+
+// next state of one word of cells, every argument holds the neighbors
+// of the cells in the same bit position (w = west, e = east)
+template<class V>
+inline V life_cells(V up_w, V up, V up_e, V w, V mid, V e, V down_w, V down, V down_e)
+{
+    // 2 bit neighbor count of the upper and lower three cells
+    V up_ones = up_w ^ up ^ up_e;
+    V up_twos = (up_w & up) | (up_e & (up_w ^ up));
+    V down_ones = down_w ^ down ^ down_e;
+    V down_twos = (down_w & down) | (down_e & (down_w ^ down));
+    V mid_ones = w ^ e;
+    V mid_twos = w & e;
+
+    // sum of the weight one bits
+    V ones = up_ones ^ down_ones ^ mid_ones;
+    V carry = (up_ones & down_ones) | (mid_ones & (up_ones ^ down_ones));
+
+    // the cell has 2 or 3 neighbors if exactly one of the weight two bits is set
+    V x = up_twos ^ down_twos;
+    V y = mid_twos ^ carry;
+    V pairs = (up_twos & down_twos) | (mid_twos & carry) | (x & y);
+    V two_or_three = (x ^ y) & ~pairs;
+
+    return two_or_three & (ones | mid);
+}
+
+// neighbor count of every cell in four bit planes, the arguments are
+// the same as the ones of life_cells()
+template<class V>
+inline void count_neighbors(V up_w, V up, V up_e, V w, V e, V down_w, V down, V down_e,
+                            V &ones, V &twos, V &fours, V &eights)
+{
+    V up_ones = up_w ^ up ^ up_e;
+    V up_twos = (up_w & up) | (up_e & (up_w ^ up));
+    V down_ones = down_w ^ down ^ down_e;
+    V down_twos = (down_w & down) | (down_e & (down_w ^ down));
+    V mid_ones = w ^ e;
+    V mid_twos = w & e;
+
+    ones = up_ones ^ down_ones ^ mid_ones;
+    V carry = (up_ones & down_ones) | (mid_ones & (up_ones ^ down_ones));
+
+    // add the four weight two bits
+    V x = up_twos ^ down_twos;
+    V y = mid_twos ^ carry;
+    V xy_fours = up_twos & down_twos;
+    V mid_fours = mid_twos & carry;
+    V pair_fours = x & y;
+    twos = x ^ y;
+    fours = xy_fours ^ mid_fours ^ pair_fours;
+    eights = (xy_fours & mid_fours) | (pair_fours & (xy_fours ^ mid_fours));
+}
+
+// next state of one word of cells under the rule with the Birth/Survival
+// neighbor count masks (see Rule), the masks are known at compile time so
+// the count tests of the missing neighbor counts are dropped by the compiler
+template<unsigned Birth, unsigned Survival>
+struct RuleCells
+{
+    template<class V>
+    inline V operator()(V up_w, V up, V up_e, V w, V mid, V e, V down_w, V down, V down_e) const
+    {
+        V ones, twos, fours, eights;
+        count_neighbors(up_w, up, up_e, w, e, down_w, down, down_e, ones, twos, fours, eights);
+
+        // no cells, for every word type
+        V born = mid ^ mid;
+        V survive = born;
+        for (unsigned count = 0; count <= 8; ++count)
+        {
+            if (((Birth | Survival) >> count) & 1)
+            {
+                V match = ((count & 1) ? ones : ~ones) & ((count & 2) ? twos : ~twos) &
+                          ((count & 4) ? fours : ~fours) & ((count & 8) ? eights : ~eights);
+                if ((Birth >> count) & 1)
+                {
+                    born = born | match;
+                }
+                if ((Survival >> count) & 1)
+                {
+                    survive = survive | match;
+                }
+            }
+        }
+        return (born & ~mid) | (survive & mid);
+    }
+};
+
+// B3/S23 only needs to know whether the count is 2 or 3
+template<>
+struct RuleCells<0x008, 0x00c>
+{
+    template<class V>
+    inline V operator()(V up_w, V up, V up_e, V w, V mid, V e, V down_w, V down, V down_e) const
+    {
+        return life_cells(up_w, up, up_e, w, mid, e, down_w, down, down_e);
+    }
+};
+
+// call Kernel<Birth, Survival>::get() for the rules which have their own kernels,
+// return a default constructed value (no kernel) for the rest
+template<template<unsigned, unsigned> class Kernel>
+inline auto rule_kernel(unsigned birth, unsigned survival) -> decltype(Kernel<0x008, 0x00c>::get())
+{
+    using result_type = decltype(Kernel<0x008, 0x00c>::get());
+
+    // B3/S23 Conway's Life
+    if (birth == 0x008 && survival == 0x00c)
+    {
+        return Kernel<0x008, 0x00c>::get();
+    }
+    // B36/S23 HighLife
+    if (birth == 0x048 && survival == 0x00c)
+    {
+        return Kernel<0x048, 0x00c>::get();
+    }
+    // B3678/S34678 Day & Night
+    if (birth == 0x1c8 && survival == 0x1d8)
+    {
+        return Kernel<0x1c8, 0x1d8>::get();
+    }
+    // B2/S Seeds
+    if (birth == 0x004 && survival == 0x000)
+    {
+        return Kernel<0x004, 0x000>::get();
+    }
+    // B3/S012345678 Life without Death
+    if (birth == 0x008 && survival == 0x1ff)
+    {
+        return Kernel<0x008, 0x1ff>::get();
+    }
+    // B36/S125 2x2
+    if (birth == 0x048 && survival == 0x026)
+    {
+        return Kernel<0x048, 0x026>::get();
+    }
+    return result_type();
+}
+
+// step the words [first, last) of a row, V::lanes words at a time, OR the changed
+// bits into changed and add the new alive cells to population; the words
+// first - 1 and last must exist, returns the first unprocessed word
+template<class V, class Cells>
+inline std::size_t life_span(const Cells &cells, const std::uint64_t *up, const std::uint64_t *mid,
+                             const std::uint64_t *down, std::uint64_t *out,
+                             std::size_t first, std::size_t last,
+                             std::uint64_t &changed, std::size_t &population)
+{
+    V changed_bits = V::zero();
+    V counts = V::zero();
+
+    std::size_t i = first;
+    for (; i + V::lanes <= last; i += V::lanes)
+    {
+        V u = V::load(up + i);
+        V m = V::load(mid + i);
+        V d = V::load(down + i);
+
+        V next = cells(V::west(u, V::load(up + i - 1)), u, V::east(u, V::load(up + i + 1)),
+                       V::west(m, V::load(mid + i - 1)), m, V::east(m, V::load(mid + i + 1)),
+                       V::west(d, V::load(down + i - 1)), d, V::east(d, V::load(down + i + 1)));
+        V::store(out + i, next);
+
+        changed_bits = changed_bits | (next ^ m);
+        counts = V::add(counts, V::popcount(next));
+    }
+
+    changed |= V::fold(changed_bits);
+    population += V::sum(counts);
+    return i;
+}
+
+} // details
+
+} // gol
+
+} // nzs
+
+#endif // NZS_LIFE_LOGIC_HPP
@@ -3,10 +3,28 @@
 
 #include "cpp_features.hpp"
 
+#include <cstddef>
 #include <string>
 #include <ostream>
 #include <iostream>
-#include <map>
+#include <streambuf>
+#include <utility>
+#include <type_traits>
+
+// the lines are formatted on the calling thread and written to the stream by
+// a background thread, so logging does not wait for the terminal
+
+// the most detailed level which is compiled in, the calls of the levels above
+// it are empty inline functions (NZS_DISABLE_LOG = 0, nothing is logged); the
+// arguments of a function call are still evaluated, the NZS_LOG_* macros at the
+// end of the file skip them too
+#ifndef NZS_LOG_LEVEL
+#ifdef NZS_DISABLE_LOG
+#define NZS_LOG_LEVEL 0
+#else
+#define NZS_LOG_LEVEL 4
+#endif
+#endif
 
 namespace Log
 {
@@ -23,7 +41,13 @@ enum Level
 namespace details
 {
 
-#ifndef NZS_DISABLE_LOG
+// the level is compiled in
+template<Level level>
+struct enabled : std::integral_constant<bool, (level <= NZS_LOG_LEVEL)>
+{
+};
+
+// used only by the writer thread
 inline std::ostream &get_ostream()
 {
     static std::ostream os(std::cerr.rdbuf());
@@ -36,59 +60,157 @@ inline ::Log::Level &get_level()
     return level;
 }
 
-inline std::map<std::string, std::string> &get_modifiers()
+// a line of the level is written: it is compiled in and not filtered by set_level()
+template<Level level>
+inline bool active()
+{
+    return enabled<level>::value && get_level() >= level;
+}
+
+// the start of the lines of every level and the end of a line, made
+// by set_color() so a line does not look them up
+struct Styles
+{
+    std::string begin[VERBOSE + 1];
+    std::string end;
+    std::string clear_line;
+};
+
+inline Styles &get_styles()
 {
-    static std::map<std::string, std::string> modifiers =
+    static Styles styles =
     {
-        // Controls
-        {"RESET_COLOR"      , "\033[0m"},
-        {"CLEAR_SCREEN"     , "[H[2J"},
-        {"CLEAR_LINE"       , "\r\033[0K"},
-
-        // Prefixes
-        {"ERROR_PREFIX"     , "[ ERROR ] "},
-        {"WARNING_PREFIX"   , "[WARNING] "},
-        {"DEBUG_PREFIX"     , "[ DEBUG ] "},
-        {"VERBOSE_PREFIX"   , "[VERBOSE] "},
+        {
+            "",
+            "[ ERROR ] ",
+            "[WARNING] ",
+            "[ DEBUG ] ",
+            "[VERBOSE] "
+        },
+        "\033[0m\n",
+        "\r\033[0K"
     };
-    return modifiers;
+    return styles;
 }
-#endif
 
-inline void print() NOEXCEPT
+// the longest line of the queue, the longer lines are cut
+const std::size_t record_size = 256;
+
+// fixed size line of a thread, so the formatting does not allocate;
+// the end of the line has its own space, so a cut line is still closed
+class LineBuffer : public std::streambuf
 {
+public:
+    static const std::size_t end_size = 8;
+
+    LineBuffer() :
+        size_(0)
+    {
+        reset();
+    }
+
+    inline void reset() NOEXCEPT
+    {
+        setp(data_, data_ + record_size - end_size);
+        size_ = 0;
+    }
+
+    // close the line with at most end_size characters
+    inline void finish(const std::string &end) NOEXCEPT
+    {
+        char *last = pptr();
+        for (std::size_t i = 0; i < end.size() && i < end_size; ++i)
+        {
+            *last++ = end[i];
+        }
+        size_ = last - data_;
+    }
+
+    inline const char *data() const NOEXCEPT
+    {
+        return data_;
+    }
+
+    inline std::size_t size() const NOEXCEPT
+    {
+        return size_;
+    }
+
+private:
+    char data_[record_size];
+    std::size_t size_;
+};
+
+// a line is made on the stack of the calling thread, so no thread local storage
+// is needed (Visual Studio 2013 has none for the classes) and making the stream
+// does not allocate
+struct LineStream
+{
+    LineStream() :
+        stream(&buffer)
+    {
+    }
+
+    LineStream(const LineStream &) = delete;
+    LineStream &operator=(const LineStream &) = delete;
+
+    LineBuffer buffer;
+    std::ostream stream;
+};
+
+// close the line and queue it for the writer thread; when the queue is full
+// an important line waits for a free place, the rest is dropped
+void submit_line(LineStream &line, const std::string &end, bool important);
+
+// change the stream of the writer thread after the queued lines
+void set_ostream(std::streambuf *sb);
+
+inline void print(std::ostream &line) NOEXCEPT
+{
+    (void)line;
 }
 
 template<typename T, typename... Args>
-inline void print(T head, Args... args)
+inline void print(std::ostream &line, T &&head, Args &&... args)
+{
+    line << std::forward<T>(head) << " ";
+    print(line, std::forward<Args>(args)...);
+}
+
+template<Level level, typename... Args>
+inline void write(std::true_type, Args &&... args)
+{
+    if (get_level() < level)
+    {
+        return;
+    }
+
+    Styles &styles = get_styles();
+    LineStream line;
+    line.stream << styles.begin[level];
+    print(line.stream, std::forward<Args>(args)...);
+    submit_line(line, styles.end, level <= WARNING);
+}
+
+// the level is not compiled in, the arguments are not even copied
+template<Level level, typename... Args>
+inline void write(std::false_type, Args &&...) NOEXCEPT
 {
-#ifndef NZS_DISABLE_LOG
-    details::get_ostream() << head << " ";
-    print(args...);
-#else
-    (void)head;
-    print(args...);
-#endif
 }
 
 } // details
 
+// wait until the queued lines are written
+void flush();
+
 inline void set_log(std::streambuf *sb)
 {
-#ifndef NZS_DISABLE_LOG
-    details::get_ostream().rdbuf(sb);
-#else
-    (void)sb;
-#endif
+    details::set_ostream(sb);
 }
 
 inline void set_level(Level level)
 {
-#ifndef NZS_DISABLE_LOG
     details::get_level() = level;
-#else
-    (void)level;
-#endif
 }
 
 inline void set_color(bool enabled)
@@ -97,123 +219,87 @@ inline void set_color(bool enabled)
     enabled = false;
 #endif
 
-#ifndef NZS_DISABLE_LOG
-    auto &modifiers = details::get_modifiers();
+    auto &styles = details::get_styles();
     if (enabled)
     {
-        modifiers["ERROR_COLOR"] =   "\033[1;31m";
-        modifiers["WARNING_COLOR"] = "\033[1;35m";
-        modifiers["DEBUG_COLOR"] =   "\033[1;33m";
-        modifiers["VERBOSE_COLOR"] = "\033[1;32m";
-        modifiers["RESET_COLOR"] =   "\033[0m";
-        modifiers["CLEAR_SCREEN"] =  "[H[2J";
-        modifiers["CLEAR_LINE"] =    "\r\033[0K";
-
+        styles.begin[ERROR] =   "[ ERROR ] \033[1;31m";
+        styles.begin[WARNING] = "\033[1;35m[WARNING] ";
+        styles.begin[DEBUG] =   "\033[1;33m[ DEBUG ] ";
+        styles.begin[VERBOSE] = "\033[1;32m[VERBOSE] ";
+        styles.end =            "\033[0m\n";
+        styles.clear_line =     "\r\033[0K";
     }
     else
     {
-        modifiers["ERROR_COLOR"] =    "";
-        modifiers["WARNING_COLOR"] =    "";
-        modifiers["DEBUG_COLOR"] =    "";
-        modifiers["VERBOSE_COLOR"] =  "";
-        modifiers["RESET_COLOR"] = "";
-        modifiers["CLEAR_SCREEN"] =  "";
-        modifiers["CLEAR_LINE"] =    "";
+        styles.begin[ERROR] =   "[ ERROR ] ";
+        styles.begin[WARNING] = "[WARNING] ";
+        styles.begin[DEBUG] =   "[ DEBUG ] ";
+        styles.begin[VERBOSE] = "[VERBOSE] ";
+        styles.end =            "\n";
+        styles.clear_line =     "";
     }
-#else
-    (void)enabled;
-#endif
 }
 
 inline void clear_line()
 {
-#ifndef NZS_DISABLE_LOG
-    auto &modifiers = details::get_modifiers();
-    details::get_ostream() << modifiers["CLEAR_LINE"];
-#endif
+    if (details::enabled<ERROR>::value)
+    {
+        details::LineStream line;
+        line.stream << details::get_styles().clear_line;
+        details::submit_line(line, "", false);
+    }
 }
 
 template<typename... Args>
-inline void error(Args... args) NOEXCEPT // LEVEL 1
+inline void error(Args &&... args) NOEXCEPT // LEVEL 1
 {
-#ifndef NZS_DISABLE_LOG
-    if (details::get_level() < Level::ERROR)
-    {
-        return;
-    }
-
-    auto &modifiers = details::get_modifiers();
-    details::get_ostream() << modifiers["ERROR_PREFIX"] << modifiers["ERROR_COLOR"];
-    details::print(args...);
-    details::get_ostream() << modifiers["RESET_COLOR"] << std::endl;
-#else
-    details::print(args...);
-#endif
+    details::write<ERROR>(details::enabled<ERROR>(), std::forward<Args>(args)...);
 }
 
 template<typename... Args>
-inline void warning(Args... args) NOEXCEPT // LEVEL 2
+inline void warning(Args &&... args) NOEXCEPT // LEVEL 2
 {
-#ifndef NZS_DISABLE_LOG
-    if (details::get_level() < Level::WARNING)
-    {
-        return;
-    }
-
-    auto &modifiers = details::get_modifiers();
-    details::get_ostream() << modifiers["WARNING_COLOR"] << modifiers["WARNING_PREFIX"];
-    details::print(args...);
-    details::get_ostream() << modifiers["RESET_COLOR"] << std::endl;
-#else
-    details::print(args...);
-#endif
+    details::write<WARNING>(details::enabled<WARNING>(), std::forward<Args>(args)...);
 }
 
 template<typename... Args>
-inline void debug(Args... args) NOEXCEPT // LEVEL 3
+inline void debug(Args &&... args) NOEXCEPT // LEVEL 3
 {
-#ifndef NZS_DISABLE_LOG
-    if (details::get_level() < Level::DEBUG)
-    {
-        return;
-    }
-
-    auto &modifiers = details::get_modifiers();
-    details::get_ostream() << modifiers["DEBUG_COLOR"] << modifiers["DEBUG_PREFIX"];
-    details::print(args...);
-    details::get_ostream() << modifiers["RESET_COLOR"] << std::endl;
-#else
-    details::print(args...);
-#endif
+    details::write<DEBUG>(details::enabled<DEBUG>(), std::forward<Args>(args)...);
 }
 
 template<typename... Args>
-inline void verbose(Args... args) NOEXCEPT // LEVEL 4
+inline void verbose(Args &&... args) NOEXCEPT // LEVEL 4
 {
-#ifndef NZS_DISABLE_LOG
-    if (details::get_level() < Level::VERBOSE)
-    {
-        return;
-    }
-
-    auto &modifiers = details::get_modifiers();
-    details::get_ostream() << modifiers["VERBOSE_COLOR"] << modifiers["VERBOSE_PREFIX"];
-    details::print(args...);
-    details::get_ostream() << details::get_modifiers()["RESET_COLOR"] << std::endl;
-#else
-    details::print(args...);
-#endif
+    details::write<VERBOSE>(details::enabled<VERBOSE>(), std::forward<Args>(args)...);
 }
 
 inline void init(int argc, const char *argv[])
 {
     (void)argc;
     (void)argv;
-#ifndef NZS_DISABLE_LOG
     set_color(true);
-#endif
 }
 
 } // log
 
+// the same as the functions of the level, but the arguments are evaluated only if
+// the line is written, so the lines of the hot paths cost one branch when they
+// are filtered and nothing when they are not compiled in:
+//     NZS_LOG_VERBOSE("generation:", game.generation(), "census:", census_text(game));
+#define NZS_LOG_AT(level, function, ...) \
+    do \
+    { \
+        if (::Log::details::active< ::Log::level>()) \
+        { \
+            ::Log::function(__VA_ARGS__); \
+        } \
+    } \
+    while (false)
+
+#define NZS_LOG_ERROR(...) NZS_LOG_AT(ERROR, error, __VA_ARGS__)
+#define NZS_LOG_WARNING(...) NZS_LOG_AT(WARNING, warning, __VA_ARGS__)
+#define NZS_LOG_DEBUG(...) NZS_LOG_AT(DEBUG, debug, __VA_ARGS__)
+#define NZS_LOG_VERBOSE(...) NZS_LOG_AT(VERBOSE, verbose, __VA_ARGS__)
+
 #endif // NZS_LOG_HPP
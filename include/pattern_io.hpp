@@ -0,0 +1,83 @@
+#ifndef NZS_PATTERN_IO_HPP
+#define NZS_PATTERN_IO_HPP
+
+#include "game_of_life.hpp"
+#include "hash_life.hpp"
+#include "brush_tool.hpp"
+#include "rule.hpp"
+#include "cpp_features.hpp"
+
+#include <string>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+// size and rule of a pattern file
+struct PatternInfo
+{
+    std::size_t width;
+    std::size_t height;
+    // the file gave a rule
+    bool has_rule;
+    Rule rule;
+};
+
+// read a plaintext (.cells) pattern: '!' starts a comment line, '.' is a dead
+// and 'O' is an alive cell; the cells are relative to the top left corner,
+// return false if the file cannot be read
+bool load_plaintext(const std::string &file_path, Brush &cells);
+
+// write the grid in plaintext format, return false if the file cannot be written
+bool save_plaintext(const std::string &file_path, const GameOfLife &game);
+
+// read a Run Length Encoded (.rle) pattern: '#' starts a comment line, the
+// "x = 3, y = 3, rule = B3/S23" header gives the size and the rule, then
+// "2bo$obo!" like runs of dead (b) and alive (o) cells follow, '$' ends a line;
+// the file is parsed in blocks, so large patterns are read without a string
+// per line, return false if the file cannot be read or it is broken
+bool load_rle(const std::string &file_path, Brush &cells, PatternInfo &info);
+
+// write the grid in RLE format with the size of the grid and the rule of the game,
+// return false if the file cannot be written
+bool save_rle(const std::string &file_path, const GameOfLife &game);
+
+// read a Macrocell (.mc) pattern of Golly into the engine: the file is a list of
+// the unique quadtree nodes, so huge and repetitive patterns are loaded in time
+// proportional to the number of nodes; return false if the file cannot be read,
+// it is broken or its rule is not B3/S23
+bool load_macrocell(const std::string &file_path, HashLife &life);
+
+// write the pattern of the engine in macrocell format
+bool save_macrocell(const std::string &file_path, const HashLife &life);
+
+// read a macrocell pattern as cells relative to its top left corner
+bool load_macrocell(const std::string &file_path, Brush &cells, PatternInfo &info);
+
+// write the grid in macrocell format, the middle of the grid goes to (0, 0)
+bool save_macrocell(const std::string &file_path, const GameOfLife &game);
+
+// read a pattern in the format of the extension (.rle, .mc or plaintext)
+bool load_pattern(const std::string &file_path, Brush &cells, PatternInfo &info);
+
+// write the grid in the format of the extension (.rle, .mc, .gol checkpoint or plaintext)
+bool save_pattern(const std::string &file_path, const GameOfLife &game);
+
+// load the pattern as the whole board: the grid grows to the size of the pattern,
+// the previous cells are killed, the pattern is placed in the middle and its rule
+// is used if the file gives one; a checkpoint (.gol) restores the whole game
+bool load_board(const std::string &file_path, GameOfLife &game);
+
+// shift the cells around (0, 0) like the brushes of the brush file
+Brush centered(const Brush &cells, const PatternInfo &info);
+
+// make the cells alive with the given offset, the cells outside of the grid are dropped
+void place(GameOfLife &game, const Brush &cells, const Position &offset);
+
+} // gol
+
+} // nzs
+
+#endif // NZS_PATTERN_IO_HPP
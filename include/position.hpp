@@ -3,6 +3,7 @@
 
 #include "cpp_features.hpp"
 
+#include <cstdint>
 #include <iostream>
 
 namespace nzs
@@ -11,59 +12,71 @@ namespace nzs
 namespace gol
 {
 
-class Position
+// cell coordinate, T is the coordinate type
+template<class T>
+class BasicPosition
 {
 public:
-    Position() = default;
+    using value_type = T;
 
-    inline Position(int x, int y) :
+    BasicPosition() = default;
+
+    inline BasicPosition(T x, T y) :
         x_(x),
         y_(y)
     {
     }
 
-    inline void set_x(int x) NOEXCEPT
+    inline void set_x(T x) NOEXCEPT
     {
         x_ = x;
     }
 
-    inline void set_y(int y) NOEXCEPT
+    inline void set_y(T y) NOEXCEPT
     {
         y_ = y;
     }
 
-    inline int get_x() const NOEXCEPT
+    inline T get_x() const NOEXCEPT
     {
         return x_;
     }
 
-    inline int get_y() const NOEXCEPT
+    inline T get_y() const NOEXCEPT
     {
         return y_;
     }
 
-    inline Position &operator+=(const Position &other) NOEXCEPT
+    inline BasicPosition &operator+=(const BasicPosition &other) NOEXCEPT
     {
         x_ += other.x_;
         y_ += other.y_;
         return *this;
     }
 private:
-    int x_;
-    int y_;
+    T x_;
+    T y_;
 };
 
-inline bool operator==(const Position &lhs, const Position &rhs) NOEXCEPT
+using Position = BasicPosition<int>;
+
+// position on the unbounded plane
+using Position64 = BasicPosition<std::int64_t>;
+
+template<class T>
+inline bool operator==(const BasicPosition<T> &lhs, const BasicPosition<T> &rhs) NOEXCEPT
 {
     return lhs.get_x() == rhs.get_x() && lhs.get_y() == rhs.get_y();
 }
 
-inline bool operator!=(const Position &lhs, const Position &rhs) NOEXCEPT
+template<class T>
+inline bool operator!=(const BasicPosition<T> &lhs, const BasicPosition<T> &rhs) NOEXCEPT
 {
     return !operator==(lhs, rhs);
 }
 
-inline Position operator+(Position lhs, const Position &rhs) NOEXCEPT
+template<class T>
+inline BasicPosition<T> operator+(BasicPosition<T> lhs, const BasicPosition<T> &rhs) NOEXCEPT
 {
     lhs += rhs;
     return lhs;
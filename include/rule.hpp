@@ -0,0 +1,76 @@
+#ifndef NZS_RULE_HPP
+#define NZS_RULE_HPP
+
+#include "cpp_features.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <string>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+// outer totalistic rule, bit n of the birth/survival mask is set if a dead cell
+// is born/an alive cell survives with n alive neighbors
+class Rule
+{
+public:
+    // B3/S23
+    Rule();
+
+    Rule(std::uint16_t birth, std::uint16_t survival);
+
+    // parse the B/S notation ("B36/S23") or the old survival/birth form ("23/36"),
+    // throws std::invalid_argument
+    static Rule parse(const std::string &rule);
+
+    // B/S notation
+    std::string to_string() const;
+
+    inline std::uint16_t birth() const NOEXCEPT
+    {
+        return birth_;
+    }
+
+    inline std::uint16_t survival() const NOEXCEPT
+    {
+        return survival_;
+    }
+
+    inline bool next(bool alive, std::size_t neighbors) const NOEXCEPT
+    {
+        return ((alive ? survival_ : birth_) >> neighbors) & 1;
+    }
+
+    // next state of every 3x3 neighborhood, bit 0..8 of the index are the cells
+    // row by row from the north-west corner (bit 4 is the cell itself)
+    inline const std::array<std::uint8_t, 512> &table() const NOEXCEPT
+    {
+        return table_;
+    }
+
+private:
+    std::uint16_t birth_;
+    std::uint16_t survival_;
+    std::array<std::uint8_t, 512> table_;
+};
+
+inline bool operator==(const Rule &lhs, const Rule &rhs) NOEXCEPT
+{
+    return lhs.birth() == rhs.birth() && lhs.survival() == rhs.survival();
+}
+
+inline bool operator!=(const Rule &lhs, const Rule &rhs) NOEXCEPT
+{
+    return !(lhs == rhs);
+}
+
+} // gol
+
+} // nzs
+
+#endif // NZS_RULE_HPP
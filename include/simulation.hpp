@@ -0,0 +1,102 @@
+#ifndef NZS_SIMULATION_HPP
+#define NZS_SIMULATION_HPP
+
+#include "game_of_life.hpp"
+#include "checkpoint.hpp"
+#include "history.hpp"
+#include "triple_buffer.hpp"
+#include "cpp_features.hpp"
+
+#include <cstddef>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <memory>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+// runs a GameOfLife on its own thread: the other threads change it through
+// commands and read the published snapshots of its cells
+class Simulation
+{
+public:
+    using command_type = std::function<void(GameOfLife &)>;
+
+    // immutable copy of the game, published whenever the cells change
+    struct Snapshot
+    {
+        BitGrid grid;
+        std::size_t generation;
+        std::size_t population;
+        // GameOfLife::version() of the copy
+        std::size_t version;
+        // measured while running, 0 when paused
+        double generations_per_second;
+    };
+
+    // start the simulation thread with a paused width_X_height game
+    Simulation(std::size_t width, std::size_t height);
+
+    // stop the simulation thread, the commands which did not run yet are dropped
+    ~Simulation();
+
+    Simulation(const Simulation &) = delete;
+    Simulation &operator=(const Simulation &) = delete;
+
+    // run the command on the simulation thread before the next generation
+    void post(command_type command);
+
+    // the latest snapshot, it is not changed until the next call (one reader thread only)
+    inline const Snapshot &snapshot() NOEXCEPT
+    {
+        return snapshots_.front();
+    }
+
+    // calculate a generation in every interval while running
+    void set_running(bool running);
+    void set_interval(std::chrono::milliseconds interval);
+
+    // ignore the interval and calculate as many generations as fit in a frame
+    // between two snapshots
+    void set_max_speed(bool max_speed);
+
+    // write checkpoints in the background by the policy while running
+    void set_autosave(const CheckpointPolicy &policy);
+
+    // go back at most steps generations (or edits), the history has a fixed size
+    void rewind(std::size_t steps);
+
+private:
+    GameOfLife game_;
+    TripleBuffer<Snapshot> snapshots_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<command_type> commands_;
+    bool running_;
+    std::chrono::milliseconds interval_;
+    bool max_speed_;
+    bool stop_;
+    double generations_per_second_;
+    // used by the simulation thread only
+    std::unique_ptr<AutoCheckpoint> autosave_;
+    History history_;
+    std::thread thread_;
+
+    void loop();
+
+    // copy the cells to the back snapshot and publish it
+    void publish();
+};
+
+} // gol
+
+} // nzs
+
+#endif // NZS_SIMULATION_HPP
@@ -0,0 +1,77 @@
+#ifndef NZS_SOUP_SEARCH_HPP
+#define NZS_SOUP_SEARCH_HPP
+
+#include "game_of_life.hpp"
+#include "rule.hpp"
+#include "census.hpp"
+#include "cpp_features.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+// the board and the random soup in its middle
+struct SoupOptions
+{
+    SoupOptions() :
+        width(128),
+        height(128),
+        soup_size(16),
+        density(0.5),
+        max_generations(100000),
+        bounded(true),
+        library(nullptr)
+    {
+    }
+
+    std::size_t width;
+    std::size_t height;
+    // the random cells are in a soup_size_X_soup_size square
+    std::size_t soup_size;
+    double density;
+    // the soups which do not stabilize until this generation are given up
+    std::size_t max_generations;
+    // the gliders leaving the soup die at the border instead of wrapping around
+    bool bounded;
+    Rule rule;
+    // the objects of the final boards are counted by this library, nullptr = no census
+    const ObjectLibrary *library;
+};
+
+// the fate of a soup
+struct SoupResult
+{
+    std::uint64_t seed;
+    // generations until the board started to repeat itself
+    std::size_t lifespan;
+    std::size_t population;
+    // period of the final board, 0 if it did not stabilize
+    std::size_t period;
+    Census census;
+};
+
+// reset the game to the soup of the seed, the same seed gives the same soup
+void make_soup(GameOfLife &game, const SoupOptions &options, std::uint64_t seed);
+
+// run the soup of the seed until it becomes static or periodic
+SoupResult run_soup(GameOfLife &game, const SoupOptions &options, std::uint64_t seed);
+
+// run the soups of the seeds first_seed ... first_seed + count - 1 on this many threads
+// (0 = one per core); every thread starts with an equal share of the seeds and takes
+// half of the rest of an other thread when it runs out, so the long lived soups do
+// not hold up the search; report is called on the threads with their index
+void search_soups(const SoupOptions &options, std::uint64_t first_seed, std::uint64_t count,
+                  std::size_t threads,
+                  const std::function<void(const SoupResult &, std::size_t)> &report);
+
+} // gol
+
+} // nzs
+
+#endif // NZS_SOUP_SEARCH_HPP
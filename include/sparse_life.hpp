@@ -0,0 +1,128 @@
+#ifndef NZS_SPARSE_LIFE_HPP
+#define NZS_SPARSE_LIFE_HPP
+
+#include "position.hpp"
+#include "rule.hpp"
+#include "bit_grid.hpp"
+#include "cpp_features.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <unordered_map>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+// unbounded plane which stores only the 64x64 tiles with alive cells; any rule
+// without B0 (a B0 rule fills the infinite empty space)
+class SparseLife
+{
+public:
+    static const std::size_t tile_size = 64;
+
+    // bit x of row y is the cell (x, y) of the tile
+    using tile_type = std::array<std::uint64_t, tile_size>;
+
+    struct TileKey
+    {
+        std::int64_t x;
+        std::int64_t y;
+    };
+
+    struct TileKeyHash
+    {
+        inline std::size_t operator()(const TileKey &key) const NOEXCEPT
+        {
+            std::uint64_t hash = static_cast<std::uint64_t>(key.x) * 0x9E3779B97F4A7C15ull;
+            hash ^= static_cast<std::uint64_t>(key.y) + (hash << 6) + (hash >> 2);
+            return static_cast<std::size_t>(hash ^ (hash >> 32));
+        }
+    };
+
+    using tile_map = std::unordered_map<TileKey, tile_type, TileKeyHash>;
+
+    SparseLife();
+
+    // false for the B0 rules
+    static bool supports(const Rule &rule) NOEXCEPT;
+
+    // kill the cell
+    void kill(const Position64 &pos);
+
+    // mark the cell alive
+    void born(const Position64 &pos);
+
+    // flip the life
+    void flip(const Position64 &pos);
+
+    // calculate the next iteration
+    void next(std::size_t iteration = 1);
+
+    // kill all cells
+    void clear();
+
+    bool is_alive(const Position64 &pos) const;
+
+    // replace the plane with the grid, the cell (0, 0) of the grid goes to offset
+    void set_cells(const BitGrid &grid, const Position64 &offset);
+
+    // append the alive cells
+    void get_cells(std::vector<Position64> &cells) const;
+
+    // throws std::invalid_argument if the rule is not supported
+    void set_rule(const Rule &rule);
+
+    inline const Rule &get_rule() const NOEXCEPT
+    {
+        return rule_;
+    }
+
+    inline std::size_t generation() const NOEXCEPT
+    {
+        return generation_;
+    }
+
+    inline std::size_t population() const NOEXCEPT
+    {
+        return population_;
+    }
+
+    // number of allocated tiles
+    inline std::size_t tile_count() const NOEXCEPT
+    {
+        return tiles_.size();
+    }
+
+    // the tiles with alive cells, the key is the tile coordinate (cell / 64)
+    inline const tile_map &tiles() const NOEXCEPT
+    {
+        return tiles_;
+    }
+
+private:
+    Rule rule_;
+    std::size_t generation_;
+    std::size_t population_;
+    tile_map tiles_;
+    // the next generation is built here and swapped with tiles_
+    tile_map next_tiles_;
+    std::vector<TileKey> candidates_;
+
+    void set_cell(const Position64 &pos, bool alive);
+};
+
+inline bool operator==(const SparseLife::TileKey &lhs, const SparseLife::TileKey &rhs) NOEXCEPT
+{
+    return lhs.x == rhs.x && lhs.y == rhs.y;
+}
+
+} // gol
+
+} // nzs
+
+#endif // NZS_SPARSE_LIFE_HPP
@@ -0,0 +1,80 @@
+#ifndef NZS_THREAD_POOL_HPP
+#define NZS_THREAD_POOL_HPP
+
+#include "cpp_features.hpp"
+
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+// fixed size pool for fork-join jobs, the calling thread works too
+class ThreadPool
+{
+public:
+    // start threads - 1 workers (0 = one thread per core)
+    explicit ThreadPool(std::size_t threads);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // call task(0) ... task(count - 1) in parallel and wait for all of them,
+    // the task is called through a pointer, so there is no allocation
+    template<class Task>
+    inline void run(std::size_t count, Task &task)
+    {
+        run(count, &invoke<Task>, &task);
+    }
+
+    // number of threads including the caller
+    inline std::size_t size() const NOEXCEPT
+    {
+        return workers_.size() + 1;
+    }
+
+private:
+    using invoker = void (*)(void *, std::size_t);
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    invoker invoke_;
+    void *task_;
+    std::size_t count_;
+    std::atomic<std::size_t> next_task_;
+    // workers which have not finished the current job yet
+    std::size_t busy_;
+    // incremented by every run() call to wake up the workers
+    std::size_t job_;
+    bool stop_;
+
+    template<class Task>
+    static void invoke(void *task, std::size_t i)
+    {
+        (*static_cast<Task *>(task))(i);
+    }
+
+    void run(std::size_t count, invoker invoke, void *task);
+
+    void worker();
+
+    // execute tasks until all of them are taken
+    void work();
+};
+
+} // gol
+
+} // nzs
+
+#endif // NZS_THREAD_POOL_HPP
@@ -0,0 +1,147 @@
+#ifndef NZS_TIMING_HPP
+#define NZS_TIMING_HPP
+
+#include "cpp_features.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+// nanoseconds in 4 buckets per power of two: 0 - 3 ns one by one, then the
+// buckets are at most 25% wide, the last one holds the times above 18 minutes
+const std::size_t timer_buckets = 4 * 40;
+
+// the counters of a histogram at a moment
+struct TimerCounts
+{
+    std::uint64_t count;
+    std::uint64_t total;
+    std::uint64_t max;
+    std::uint64_t buckets[timer_buckets];
+};
+
+// the times of a phase, in nanoseconds
+struct TimerSummary
+{
+    std::string name;
+    std::uint64_t count;
+    double mean;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+};
+
+// the durations of a phase; record() is a few relaxed atomic additions, so any
+// thread can record without a lock
+class Histogram
+{
+public:
+    explicit Histogram(const std::string &name);
+
+    Histogram(const Histogram &) = delete;
+    Histogram &operator=(const Histogram &) = delete;
+
+    void record(std::uint64_t nanoseconds) NOEXCEPT;
+
+    // the counters are read one by one, the recording threads do not wait
+    TimerCounts counts() const NOEXCEPT;
+
+    inline const std::string &name() const NOEXCEPT
+    {
+        return name_;
+    }
+
+private:
+    std::string name_;
+    std::atomic<std::uint64_t> count_;
+    std::atomic<std::uint64_t> total_;
+    std::atomic<std::uint64_t> max_;
+    std::atomic<std::uint64_t> buckets_[timer_buckets];
+};
+
+// the recordings between two counts of the same histogram; the max of the
+// difference is the top of its highest bucket
+TimerCounts difference(const TimerCounts &now, const TimerCounts &before) NOEXCEPT;
+
+// the mean, the percentiles (the middle of their buckets) and the max
+TimerSummary summarize(const std::string &name, const TimerCounts &counts);
+
+// the histogram of the name, made at the first call; the reference stays valid
+// until the exit, so the call sites keep it in a static:
+//     static Histogram &timer = get_timer("GameOfLife::next");
+Histogram &get_timer(const std::string &name);
+
+// the histograms in the order of their first use
+std::vector<const Histogram *> all_timers();
+
+inline std::atomic<bool> &timing_flag() NOEXCEPT
+{
+    static std::atomic<bool> enabled(false);
+    return enabled;
+}
+
+// the timers do not read the clock while the timing is off (the default)
+inline void set_timing(bool enabled) NOEXCEPT
+{
+    timing_flag().store(enabled, std::memory_order_relaxed);
+}
+
+inline bool timing_enabled() NOEXCEPT
+{
+    return timing_flag().load(std::memory_order_relaxed);
+}
+
+// the summaries of all timers as JSON, the times in microseconds
+void write_timers(std::ostream &out);
+
+// return false if the file cannot be written
+bool write_timers(const std::string &file_path);
+
+// record the lifetime of the scope into the histogram
+class ScopedTimer
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    explicit ScopedTimer(Histogram &histogram) NOEXCEPT :
+        histogram_(timing_enabled() ? &histogram : nullptr)
+    {
+        if (histogram_)
+        {
+            start_ = clock_type::now();
+        }
+    }
+
+    ~ScopedTimer()
+    {
+        if (histogram_)
+        {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start_);
+            histogram_->record(static_cast<std::uint64_t>(elapsed.count()));
+        }
+    }
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+    Histogram *histogram_;
+    clock_type::time_point start_;
+};
+
+} // gol
+
+} // nzs
+
+#endif // NZS_TIMING_HPP
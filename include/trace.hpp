@@ -0,0 +1,107 @@
+#ifndef NZS_TRACE_HPP
+#define NZS_TRACE_HPP
+
+#include "cpp_features.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <ostream>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+// a span of a thread, the names are string literals (only the pointer is kept)
+struct TraceEvent
+{
+    const char *name;
+    const char *category;
+    // nanoseconds since the first trace_clock() call
+    std::uint64_t begin;
+    std::uint64_t duration;
+    // an optional number shown with the event, nullptr = none
+    const char *arg_name;
+    std::int64_t arg;
+};
+
+// a thread keeps at most this many events, the later ones are counted only
+const std::size_t max_trace_events = 1 << 18;
+
+inline std::atomic<bool> &tracing_flag() NOEXCEPT
+{
+    static std::atomic<bool> enabled(false);
+    return enabled;
+}
+
+// the events are not recorded while the tracing is off (the default)
+inline void set_tracing(bool enabled) NOEXCEPT
+{
+    tracing_flag().store(enabled, std::memory_order_relaxed);
+}
+
+inline bool tracing_enabled() NOEXCEPT
+{
+    return tracing_flag().load(std::memory_order_relaxed);
+}
+
+std::uint64_t trace_clock() NOEXCEPT;
+
+// add the event to the buffer of the calling thread; every thread has its own
+// buffer, the lock of a buffer is taken by an other thread only when writing
+void record_event(const TraceEvent &event);
+
+// the name of the calling thread in the trace, a string literal (only the pointer
+// is kept); no buffer is made for the thread until it records an event
+void set_thread_name(const char *name);
+
+// write the events of all threads in the trace event format of Chrome
+// (about:tracing, ui.perfetto.dev) and remove them
+void write_trace(std::ostream &out);
+
+// return false if the file cannot be written
+bool write_trace(const std::string &file_path);
+
+// remove the recorded events
+void clear_trace();
+
+// record the lifetime of the scope as an event
+class ScopedTrace
+{
+public:
+    explicit ScopedTrace(const char *name, const char *category,
+                         const char *arg_name = nullptr, std::int64_t arg = 0) NOEXCEPT :
+        event_({name, category, 0, 0, arg_name, arg}),
+        enabled_(tracing_enabled())
+    {
+        if (enabled_)
+        {
+            event_.begin = trace_clock();
+        }
+    }
+
+    ~ScopedTrace()
+    {
+        if (enabled_)
+        {
+            event_.duration = trace_clock() - event_.begin;
+            record_event(event_);
+        }
+    }
+
+    ScopedTrace(const ScopedTrace &) = delete;
+    ScopedTrace &operator=(const ScopedTrace &) = delete;
+
+private:
+    TraceEvent event_;
+    bool enabled_;
+};
+
+} // gol
+
+} // nzs
+
+#endif // NZS_TRACE_HPP
@@ -0,0 +1,77 @@
+#ifndef NZS_TRIPLE_BUFFER_HPP
+#define NZS_TRIPLE_BUFFER_HPP
+
+#include "cpp_features.hpp"
+
+#include <array>
+#include <atomic>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+// lock-free hand over of the latest value from one writer thread to one reader
+// thread: the writer fills back() and publishes it, the reader takes the latest
+// published value, neither of them waits for the other
+template<class T>
+class TripleBuffer
+{
+public:
+    // every slot starts with value
+    explicit TripleBuffer(const T &value = T()) :
+        slots_{{value, value, value}},
+        back_(0),
+        front_(1),
+        middle_(2)
+    {
+    }
+
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    // the slot of the writer
+    inline T &back() NOEXCEPT
+    {
+        return slots_[back_];
+    }
+
+    // make the back slot the latest value, the writer continues in an other slot
+    inline void publish() NOEXCEPT
+    {
+        back_ = middle_.exchange(back_ | fresh, std::memory_order_acq_rel) & index_mask;
+    }
+
+    // the latest published value, it is not changed until the next call of the reader
+    inline const T &front() NOEXCEPT
+    {
+        if (middle_.load(std::memory_order_relaxed) & fresh)
+        {
+            front_ = middle_.exchange(front_, std::memory_order_acq_rel) & index_mask;
+        }
+        return slots_[front_];
+    }
+
+private:
+    static const unsigned index_mask = 3;
+    // the middle slot was published since the reader took a slot
+    static const unsigned fresh = 4;
+
+    std::array<T, 3> slots_;
+    unsigned back_;
+    unsigned front_;
+    std::atomic<unsigned> middle_;
+};
+
+template<class T>
+const unsigned TripleBuffer<T>::index_mask;
+
+template<class T>
+const unsigned TripleBuffer<T>::fresh;
+
+} // gol
+
+} // nzs
+
+#endif // NZS_TRIPLE_BUFFER_HPP
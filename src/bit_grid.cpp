@@ -0,0 +1,97 @@
+#include "bit_grid.hpp"
+#include "cpp_features.hpp"
+
+#include <algorithm>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+const std::size_t BitGrid::word_bits;
+
+namespace
+{
+
+inline std::size_t words_for(std::size_t width) NOEXCEPT
+{
+    return (width + BitGrid::word_bits - 1) / BitGrid::word_bits;
+}
+
+} // anonymous
+
+BitGrid::BitGrid(std::size_t width, std::size_t height) :
+    width_(width),
+    height_(height),
+    words_per_row_(words_for(width)),
+    // one extra row for zero_row()
+    words_((height + 1) * words_per_row_, 0)
+{
+}
+
+void BitGrid::clear() NOEXCEPT
+{
+    std::fill(words_.begin(), words_.end(), 0);
+}
+
+void BitGrid::resize(std::size_t width, std::size_t height)
+{
+    BitGrid tmp(width, height);
+    auto min_h = std::min(height_, height);
+    auto min_words = std::min(words_per_row_, tmp.words_per_row_);
+
+    for (std::size_t y = 0; y < min_h; ++y)
+    {
+        std::copy(row(y), row(y) + min_words, tmp.row(y));
+        if (min_words != 0 && min_words == tmp.words_per_row_)
+        {
+            // drop the cells which are out of the new width
+            tmp.row(y)[min_words - 1] &= tmp.tail_mask();
+        }
+    }
+
+    swap(tmp);
+}
+
+std::size_t BitGrid::count() const NOEXCEPT
+{
+    return count(0, height_);
+}
+
+std::size_t BitGrid::count(std::size_t first_row, std::size_t last_row) const NOEXCEPT
+{
+    std::size_t alive = 0;
+    for (std::size_t i = first_row * words_per_row_; i < last_row * words_per_row_; ++i)
+    {
+        alive += details::popcount(words_[i]);
+    }
+    return alive;
+}
+
+std::size_t BitGrid::count(std::size_t first_row, std::size_t last_row,
+                          std::size_t first_word, std::size_t last_word) const NOEXCEPT
+{
+    std::size_t alive = 0;
+    for (std::size_t y = first_row; y < last_row; ++y)
+    {
+        const word_type *words = row(y);
+        for (std::size_t i = first_word; i < last_word; ++i)
+        {
+            alive += details::popcount(words[i]);
+        }
+    }
+    return alive;
+}
+
+void BitGrid::swap(BitGrid &other) NOEXCEPT
+{
+    std::swap(width_, other.width_);
+    std::swap(height_, other.height_);
+    std::swap(words_per_row_, other.words_per_row_);
+    words_.swap(other.words_);
+}
+
+} // gol
+
+} // nzs
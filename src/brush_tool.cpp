@@ -17,9 +17,10 @@ BrushTool::BrushTool() :
     add({});
 }
 
-void BrushTool::add(Brush brush)
+void BrushTool::add(Brush brush, std::string name)
 {
     brushs_.push_back(std::move(brush));
+    names_.push_back(std::move(name));
     Log::verbose("new brush added");
 }
 
@@ -28,6 +29,11 @@ const Brush &BrushTool::get() const
     return brushs_[brush_id_];
 }
 
+const std::string &BrushTool::name() const
+{
+    return names_[brush_id_];
+}
+
 void BrushTool::next() NOEXCEPT
 {
     ++brush_id_;
@@ -74,22 +80,30 @@ void BrushTool::load_from_file(const std::string &file_path, BrushTool &bt)
     }
 
     std::string line;
+    std::string name;
     Brush actual_brush;
     int offset_x, offset_y;
     while (!file.eof())
     {
         std::getline(file, line);
 
-        // ignore empty line or comment
-        if (line.size() == 0 || line[0] == '#')
+        // ignore empty line
+        if (line.size() == 0)
         {
             continue;
         }
+        // the last comment before a brush is its name
+        else if (line[0] == '#')
+        {
+            std::size_t first = line.find_first_not_of("# ");
+            name = first == std::string::npos ? std::string() : line.substr(first);
+        }
         // add the brush and create an empty brush
         else if (line == "end")
         {
-            bt.add(std::move(actual_brush));
+            bt.add(std::move(actual_brush), std::move(name));
             actual_brush.clear();
+            name.clear();
         }
         // read the x,y offset and add to the brush
         else if (read_offset(line, offset_x, offset_y))
@@ -102,7 +116,7 @@ void BrushTool::load_from_file(const std::string &file_path, BrushTool &bt)
             Log::warning("bad format: " + line);
         }
     }
-    Log::debug("bursh file loaded: " + file_path);
+    NZS_LOG_DEBUG("bursh file loaded: " + file_path);
 }
 
 } // gol
@@ -0,0 +1,401 @@
+#include "census.hpp"
+#include "game_of_life.hpp"
+#include "log.hpp"
+#include "cpp_features.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace
+{
+
+// the library patterns are followed for this many generations
+const std::size_t max_phases = 64;
+
+// alive cells [begin, end) of row y, parent joins the touching runs
+struct Run
+{
+    std::size_t y;
+    std::size_t begin;
+    std::size_t end;
+    std::size_t parent;
+};
+
+std::size_t root(std::vector<Run> &runs, std::size_t i)
+{
+    while (runs[i].parent != i)
+    {
+        // path halving
+        runs[i].parent = runs[runs[i].parent].parent;
+        i = runs[i].parent;
+    }
+    return i;
+}
+
+// the smaller index becomes the root, so a root is the first run of its object
+void join(std::vector<Run> &runs, std::size_t a, std::size_t b)
+{
+    a = root(runs, a);
+    b = root(runs, b);
+    if (a < b)
+    {
+        runs[b].parent = a;
+    }
+    else if (b < a)
+    {
+        runs[a].parent = b;
+    }
+}
+
+// the runs of a row with a word at a time, a run may continue in the next word
+void add_runs(const BitGrid::word_type *row, std::size_t words, std::size_t y,
+              std::vector<Run> &runs)
+{
+    bool in_run = false;
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < words; ++i)
+    {
+        BitGrid::word_type word = row[i];
+        std::size_t bit = 0;
+        while (bit < BitGrid::word_bits)
+        {
+            BitGrid::word_type rest = (in_run ? ~word : word) >> bit;
+            if (rest == 0)
+            {
+                break;
+            }
+            bit += details::lowest_bit(rest);
+            if (in_run)
+            {
+                runs.push_back(Run{y, start, i * BitGrid::word_bits + bit, runs.size()});
+            }
+            else
+            {
+                start = i * BitGrid::word_bits + bit;
+            }
+            in_run = !in_run;
+        }
+    }
+    if (in_run)
+    {
+        runs.push_back(Run{y, start, words * BitGrid::word_bits, runs.size()});
+    }
+}
+
+// call visit with the cells of every 8-connected object of the grid
+template<class Visit>
+void for_each_object(const BitGrid &grid, Visit visit)
+{
+    std::vector<Run> runs;
+    std::size_t words = grid.words_per_row();
+    std::size_t previous = 0;
+    for (std::size_t y = 0; y < grid.get_height(); ++y)
+    {
+        std::size_t current = runs.size();
+        add_runs(grid.row(y), words, y, runs);
+
+        // a run touches the runs of the row above which reach one cell beyond it
+        std::size_t above = previous;
+        for (std::size_t i = current; i < runs.size(); ++i)
+        {
+            while (above < current && runs[above].end < runs[i].begin)
+            {
+                ++above;
+            }
+            for (std::size_t j = above; j < current && runs[j].begin <= runs[i].end; ++j)
+            {
+                join(runs, j, i);
+            }
+        }
+        previous = current;
+    }
+
+    // counting sort of the runs by object, the rows stay in order
+    std::vector<std::size_t> object(runs.size());
+    std::vector<std::size_t> first{0};
+    for (std::size_t i = 0; i < runs.size(); ++i)
+    {
+        std::size_t r = root(runs, i);
+        if (r == i)
+        {
+            object[i] = first.size() - 1;
+            first.push_back(0);
+        }
+        else
+        {
+            object[i] = object[r];
+        }
+        ++first[object[i] + 1];
+    }
+    for (std::size_t i = 1; i < first.size(); ++i)
+    {
+        first[i] += first[i - 1];
+    }
+    std::vector<std::size_t> order(runs.size());
+    std::vector<std::size_t> next(first.begin(), first.end() - 1);
+    for (std::size_t i = 0; i < runs.size(); ++i)
+    {
+        order[next[object[i]]++] = i;
+    }
+
+    std::vector<Position> cells;
+    for (std::size_t o = 0; o + 1 < first.size(); ++o)
+    {
+        cells.clear();
+        for (std::size_t i = first[o]; i < first[o + 1]; ++i)
+        {
+            const Run &run = runs[order[i]];
+            for (std::size_t x = run.begin; x < run.end; ++x)
+            {
+                cells.push_back({static_cast<int>(x), static_cast<int>(run.y)});
+            }
+        }
+        visit(cells);
+    }
+}
+
+const std::string unknown;
+
+} // anonymous
+
+std::string canonical_code(std::vector<Position> cells)
+{
+    if (cells.empty())
+    {
+        return "0x0:";
+    }
+
+    int min_x = std::numeric_limits<int>::max();
+    int min_y = std::numeric_limits<int>::max();
+    int max_x = std::numeric_limits<int>::min();
+    int max_y = std::numeric_limits<int>::min();
+    for (const auto &cell : cells)
+    {
+        min_x = std::min(min_x, cell.get_x());
+        min_y = std::min(min_y, cell.get_y());
+        max_x = std::max(max_x, cell.get_x());
+        max_y = std::max(max_y, cell.get_y());
+    }
+    std::uint64_t width = max_x - min_x + 1;
+    std::uint64_t height = max_y - min_y + 1;
+
+    // the cells of an orientation as y << 32 | x, sorted; the narrowest
+    // orientation with the smallest cells is the canonical one
+    std::vector<std::uint64_t> best;
+    std::vector<std::uint64_t> shape(cells.size());
+    std::uint64_t best_width = 0;
+    for (int orientation = 0; orientation < 8; ++orientation)
+    {
+        bool flip_x = orientation & 1;
+        bool flip_y = orientation & 2;
+        bool transpose = orientation & 4;
+        for (std::size_t i = 0; i < cells.size(); ++i)
+        {
+            std::uint64_t x = cells[i].get_x() - min_x;
+            std::uint64_t y = cells[i].get_y() - min_y;
+            x = flip_x ? width - 1 - x : x;
+            y = flip_y ? height - 1 - y : y;
+            shape[i] = transpose ? (x << 32 | y) : (y << 32 | x);
+        }
+        std::sort(shape.begin(), shape.end());
+
+        std::uint64_t shape_width = transpose ? height : width;
+        if (best.empty() || shape_width < best_width || (shape_width == best_width && shape < best))
+        {
+            best.swap(shape);
+            shape.resize(cells.size());
+            best_width = shape_width;
+        }
+    }
+
+    std::uint64_t code_width = best_width;
+    std::uint64_t code_height = best_width == width ? height : width;
+    std::string code = std::to_string(code_width) + "x" + std::to_string(code_height) + ":";
+    std::size_t next = 0;
+    const char *digits = "0123456789abcdef";
+    for (std::uint64_t y = 0; y < code_height; ++y)
+    {
+        if (y != 0)
+        {
+            code += '/';
+        }
+        for (std::uint64_t x = 0; x < code_width; x += 4)
+        {
+            int digit = 0;
+            while (next < best.size() && (best[next] >> 32) == y && (best[next] & 0xffffffff) < x + 4)
+            {
+                digit |= 1 << ((best[next] & 0xffffffff) - x);
+                ++next;
+            }
+            code += digits[digit];
+        }
+    }
+    return code;
+}
+
+void ObjectLibrary::add(const std::string &name, const Brush &cells)
+{
+    if (cells.empty())
+    {
+        return;
+    }
+
+    int min_x = cells[0].get_x();
+    int min_y = cells[0].get_y();
+    int max_x = min_x;
+    int max_y = min_y;
+    for (const auto &cell : cells)
+    {
+        min_x = std::min(min_x, cell.get_x());
+        min_y = std::min(min_y, cell.get_y());
+        max_x = std::max(max_x, cell.get_x());
+        max_y = std::max(max_y, cell.get_y());
+    }
+
+    // the pattern can move by one cell per generation in any direction
+    int margin = static_cast<int>(max_phases) + 2;
+    GameOfLife game(max_x - min_x + 1 + 2 * margin, max_y - min_y + 1 + 2 * margin);
+    game.toggle_boundary();
+    for (const auto &cell : cells)
+    {
+        game.born({cell.get_x() - min_x + margin, cell.get_y() - min_y + margin});
+    }
+
+    // the shape of every generation, empty if it is not one object; the first
+    // repeated shape closes the cycle (a moving one included), the same shape
+    // has the same future in any position and orientation
+    std::vector<std::string> codes;
+    std::unordered_map<std::string, std::size_t> seen;
+    std::size_t cycle = max_phases + 1;
+    for (std::size_t generation = 0; generation <= max_phases; ++generation)
+    {
+        if (generation != 0)
+        {
+            game.next();
+        }
+        std::size_t objects = 0;
+        std::string code;
+        for_each_object(game.grid(), [&](const std::vector<Position> &object)
+        {
+            ++objects;
+            code = canonical_code(object);
+        });
+        if (objects != 1)
+        {
+            codes.push_back(std::string());
+            continue;
+        }
+
+        auto first = seen.find(code);
+        if (first != seen.end())
+        {
+            cycle = first->second;
+            break;
+        }
+        seen.insert({code, generation});
+        codes.push_back(code);
+    }
+
+    // the given shape is known even if it does not cycle
+    if (!codes[0].empty())
+    {
+        names_.insert({codes[0], name});
+    }
+    for (std::size_t i = cycle; i < codes.size(); ++i)
+    {
+        // the first name of a shape stays
+        if (!codes[i].empty())
+        {
+            names_.insert({codes[i], name});
+        }
+    }
+}
+
+bool ObjectLibrary::load_brushes(const std::string &file_path)
+{
+    std::ifstream file(file_path);
+    if (!file.is_open())
+    {
+        Log::error("file not found:", file_path);
+        return false;
+    }
+
+    // the same format as BrushTool::load_from_file
+    std::string line;
+    std::string name;
+    Brush cells;
+    while (std::getline(file, line))
+    {
+        std::istringstream offset(line);
+        int x = 0;
+        int y = 0;
+        if (line.empty())
+        {
+            continue;
+        }
+        else if (line[0] == '#')
+        {
+            name = line.substr(line.find_first_not_of("# ") == std::string::npos ?
+                               line.size() : line.find_first_not_of("# "));
+        }
+        else if (line == "end")
+        {
+            add(name, cells);
+            cells.clear();
+        }
+        else if (offset >> x >> y)
+        {
+            cells.push_back({x, y});
+        }
+    }
+    Log::debug("object library loaded:", file_path, "shapes:", names_.size());
+    return true;
+}
+
+const std::string &ObjectLibrary::find(const std::string &code) const
+{
+    auto name = names_.find(code);
+    return name == names_.end() ? unknown : name->second;
+}
+
+Census take_census(const BitGrid &grid, const ObjectLibrary &library)
+{
+    Census census{{}, 0};
+    std::unordered_map<std::string, std::size_t> index;
+    for_each_object(grid, [&](const std::vector<Position> &cells)
+    {
+        ++census.objects;
+        std::string code = canonical_code(cells);
+        auto entry = index.find(code);
+        if (entry != index.end())
+        {
+            ++census.entries[entry->second].count;
+            return;
+        }
+
+        const std::string &name = library.find(code);
+        index.insert({code, census.entries.size()});
+        census.entries.push_back(CensusEntry{name.empty() ? code : name, code, cells.size(), 1,
+                                             !name.empty()});
+    });
+
+    std::sort(census.entries.begin(), census.entries.end(),
+              [](const CensusEntry & a, const CensusEntry & b)
+    {
+        return a.count != b.count ? a.count > b.count : a.name < b.name;
+    });
+    return census;
+}
+
+} // gol
+
+} // nzs
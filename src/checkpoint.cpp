@@ -0,0 +1,820 @@
+#include "checkpoint.hpp"
+#include "log.hpp"
+#include "cpp_features.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <vector>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define NZS_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace
+{
+
+// header: magic, format version, flags, width, height, generation, population,
+// birth and survival mask, write sequence number, payload size; every number is
+// little endian
+const char magic[8] = {'N', 'Z', 'S', 'G', 'O', 'L', 'C', 'P'};
+const std::uint32_t format_version = 1;
+const std::uint32_t flag_bounded = 1;
+const std::uint32_t flag_compressed = 2;
+const std::size_t header_size = 64;
+const std::size_t checksum_size = 8;
+
+// the largest grid a checkpoint may hold: 2^32 cells per side and 16 GiB of words,
+// a damaged header is rejected before the grid is allocated
+const std::uint64_t max_side = std::uint64_t(1) << 32;
+const std::uint64_t max_grid_words = std::uint64_t(1) << 31;
+
+// words of the payload which are written at once
+const std::size_t block_words = 1 << 16;
+
+inline std::uint64_t to_little(std::uint64_t word) NOEXCEPT
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return __builtin_bswap64(word);
+#else
+    return word;
+#endif
+}
+
+inline void put(std::uint8_t *out, std::uint64_t value, std::size_t bytes) NOEXCEPT
+{
+    for (std::size_t i = 0; i < bytes; ++i)
+    {
+        out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+    }
+}
+
+inline std::uint64_t get(const std::uint8_t *in, std::size_t bytes) NOEXCEPT
+{
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < bytes; ++i)
+    {
+        value |= std::uint64_t(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+inline std::uint64_t get_word(const std::uint8_t *in) NOEXCEPT
+{
+    std::uint64_t word;
+    std::memcpy(&word, in, sizeof(word));
+    return to_little(word);
+}
+
+// checksum of the grid words
+inline std::uint64_t mix(std::uint64_t hash, std::uint64_t word) NOEXCEPT
+{
+    return (hash ^ word) * 0x100000001b3ull;
+}
+
+const std::uint64_t checksum_seed = 0xcbf29ce484222325ull;
+
+// the payload is a list of tokens: the low half of a token is the number of zero
+// words, the high half is the number of the following literal words
+class PayloadWriter
+{
+public:
+    explicit PayloadWriter(std::ostream &stream) :
+        stream_(stream),
+        size_(0)
+    {
+        block_.reserve(block_words);
+    }
+
+    inline void push(std::uint64_t word)
+    {
+        block_.push_back(to_little(word));
+        if (block_.size() == block_words)
+        {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        stream_.write(reinterpret_cast<const char *>(block_.data()),
+                      block_.size() * sizeof(std::uint64_t));
+        size_ += block_.size() * sizeof(std::uint64_t);
+        block_.clear();
+    }
+
+    // bytes written
+    inline std::uint64_t size() const NOEXCEPT
+    {
+        return size_;
+    }
+
+private:
+    std::ostream &stream_;
+    std::vector<std::uint64_t> block_;
+    std::uint64_t size_;
+};
+
+// read only view of a whole file
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string &file_path) :
+        data_(nullptr),
+        size_(0)
+    {
+#ifdef NZS_HAS_MMAP
+        int fd = ::open(file_path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return;
+        }
+        struct stat status;
+        if (::fstat(fd, &status) == 0 && status.st_size > 0)
+        {
+            void *mapping = ::mmap(nullptr, static_cast<std::size_t>(status.st_size),
+                                   PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED)
+            {
+                ::madvise(mapping, static_cast<std::size_t>(status.st_size), MADV_SEQUENTIAL);
+                data_ = static_cast<const std::uint8_t *>(mapping);
+                size_ = static_cast<std::size_t>(status.st_size);
+            }
+        }
+        // the mapping stays valid without the descriptor
+        ::close(fd);
+#else
+        std::ifstream file(file_path, std::ios::binary);
+        if (file.is_open())
+        {
+            buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            data_ = reinterpret_cast<const std::uint8_t *>(buffer_.data());
+            size_ = buffer_.size();
+        }
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifdef NZS_HAS_MMAP
+        if (data_ != nullptr)
+        {
+            ::munmap(const_cast<std::uint8_t *>(data_), size_);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    inline const std::uint8_t *data() const NOEXCEPT
+    {
+        return data_;
+    }
+
+    inline std::size_t size() const NOEXCEPT
+    {
+        return size_;
+    }
+
+private:
+    const std::uint8_t *data_;
+    std::size_t size_;
+#ifndef NZS_HAS_MMAP
+    std::vector<char> buffer_;
+#endif
+};
+
+// decode the payload to the words, return false if it does not fill them exactly
+bool decode(const std::uint8_t *payload, std::uint64_t size, bool compressed,
+            BitGrid::word_type *words, std::size_t count)
+{
+    if (!compressed)
+    {
+        if (size != count * sizeof(std::uint64_t))
+        {
+            return false;
+        }
+        std::memcpy(words, payload, size);
+        if (to_little(1) != 1)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                words[i] = to_little(words[i]);
+            }
+        }
+        return true;
+    }
+
+    const std::uint8_t *end = payload + size;
+    std::size_t pos = 0;
+    while (end - payload >= 8)
+    {
+        std::uint64_t token = get_word(payload);
+        payload += 8;
+        std::uint64_t zeros = token & 0xffffffffull;
+        std::uint64_t literals = token >> 32;
+        if (zeros > count - pos || literals > count - pos - zeros ||
+                literals > static_cast<std::uint64_t>(end - payload) / 8)
+        {
+            return false;
+        }
+        std::fill(words + pos, words + pos + zeros, 0);
+        pos += zeros;
+        for (std::uint64_t i = 0; i < literals; ++i, payload += 8)
+        {
+            words[pos++] = get_word(payload);
+        }
+    }
+    return payload == end && pos == count;
+}
+
+struct Header
+{
+    std::uint64_t width;
+    std::uint64_t height;
+    std::uint64_t generation;
+    std::uint64_t population;
+    std::uint16_t birth;
+    std::uint16_t survival;
+    std::uint64_t payload_size;
+    std::uint64_t checksum;
+    bool bounded;
+    bool compressed;
+};
+
+// parse and bound the header of a mapped checkpoint, the errors are logged
+bool read_header(const MappedFile &file, const std::string &file_path, Header &header)
+{
+    if (file.data() == nullptr)
+    {
+        Log::error("file not found:", file_path);
+        return false;
+    }
+
+    const std::uint8_t *data = file.data();
+    if (file.size() < header_size + checksum_size ||
+            std::memcmp(data, magic, sizeof(magic)) != 0)
+    {
+        Log::error("not a checkpoint:", file_path);
+        return false;
+    }
+    if (get(data + 8, 4) != format_version)
+    {
+        Log::error("unsupported checkpoint version:", get(data + 8, 4), "in", file_path);
+        return false;
+    }
+
+    std::uint64_t flags = get(data + 12, 4);
+    header.width = get(data + 16, 8);
+    header.height = get(data + 24, 8);
+    header.generation = get(data + 32, 8);
+    header.population = get(data + 40, 8);
+    header.birth = static_cast<std::uint16_t>(get(data + 48, 2));
+    header.survival = static_cast<std::uint16_t>(get(data + 50, 2));
+    header.payload_size = get(data + 56, 8);
+    header.bounded = (flags & flag_bounded) != 0;
+    header.compressed = (flags & flag_compressed) != 0;
+
+    // the size must fit in the memory before the grid is allocated; the grid has
+    // an extra zero row, an uncompressed payload holds every other word
+    const std::uint64_t max_words = std::min<std::uint64_t>(
+                                        max_grid_words,
+                                        std::numeric_limits<std::size_t>::max() / sizeof(std::uint64_t) / 2);
+    std::uint64_t words_per_row = (header.width + BitGrid::word_bits - 1) / BitGrid::word_bits;
+    if (header.payload_size != file.size() - header_size - checksum_size ||
+            header.width > max_side || header.height > max_side ||
+            words_per_row > max_words / (header.height + 1) ||
+            (!header.compressed &&
+             header.payload_size != words_per_row * header.height * sizeof(std::uint64_t)) ||
+            header.birth > 0x1ff || header.survival > 0x1ff)
+    {
+        Log::error("broken checkpoint header:", file_path);
+        return false;
+    }
+    header.checksum = get(data + header_size + header.payload_size, checksum_size);
+    return true;
+}
+
+// mix(hash, 0) repeated count times
+std::uint64_t mix_zeros(std::uint64_t hash, std::uint64_t count)
+{
+    std::uint64_t factor = 0x100000001b3ull;
+    for (; count != 0; count >>= 1, factor *= factor)
+    {
+        if (count & 1)
+        {
+            hash *= factor;
+        }
+    }
+    return hash;
+}
+
+// check a checkpoint like load_checkpoint without allocating the grid: the
+// payload is walked in place, the zero runs are hashed without being expanded
+bool check_checkpoint(const std::string &file_path)
+{
+    MappedFile file(file_path);
+    Header header;
+    if (!read_header(file, file_path, header))
+    {
+        return false;
+    }
+
+    const std::uint64_t words_per_row = (header.width + BitGrid::word_bits - 1) / BitGrid::word_bits;
+    const std::uint64_t count = words_per_row * header.height;
+    const std::uint64_t tail_bits = header.width % BitGrid::word_bits;
+    const std::uint64_t tail_mask = tail_bits == 0 ? ~0ull : (1ull << tail_bits) - 1;
+    const std::uint8_t *payload = file.data() + header_size;
+    const std::uint8_t *end = payload + header.payload_size;
+    std::uint64_t checksum = checksum_seed;
+    std::uint64_t population = 0;
+    std::uint64_t pos = 0;
+    auto literal = [&](std::uint64_t word)
+    {
+        checksum = mix(checksum, word);
+        // no cell outside of the grid
+        if (++pos % words_per_row == 0)
+        {
+            word &= tail_mask;
+        }
+        population += details::popcount(word);
+    };
+
+    if (!header.compressed)
+    {
+        for (; payload != end; payload += 8)
+        {
+            literal(get_word(payload));
+        }
+    }
+    else
+    {
+        while (end - payload >= 8)
+        {
+            std::uint64_t token = get_word(payload);
+            payload += 8;
+            std::uint64_t zeros = token & 0xffffffffull;
+            std::uint64_t literals = token >> 32;
+            if (zeros > count - pos || literals > count - pos - zeros ||
+                    literals > static_cast<std::uint64_t>(end - payload) / 8)
+            {
+                break;
+            }
+            checksum = mix_zeros(checksum, zeros);
+            pos += zeros;
+            for (std::uint64_t i = 0; i < literals; ++i, payload += 8)
+            {
+                literal(get_word(payload));
+            }
+        }
+    }
+    if (payload != end || pos != count)
+    {
+        Log::error("broken checkpoint payload:", file_path);
+        return false;
+    }
+    if (checksum != header.checksum)
+    {
+        Log::error("checkpoint checksum mismatch:", file_path);
+        return false;
+    }
+    if (population != header.population)
+    {
+        Log::error("checkpoint population mismatch:", file_path);
+        return false;
+    }
+    return true;
+}
+
+// the write sequence number in the header of a checkpoint file
+bool read_sequence(const std::string &file_path, std::uint32_t &sequence)
+{
+    std::ifstream file(file_path, std::ios::binary);
+    std::uint8_t header[header_size];
+    if (!file.read(reinterpret_cast<char *>(header), header_size) ||
+            std::memcmp(header, magic, sizeof(magic)) != 0)
+    {
+        return false;
+    }
+    sequence = static_cast<std::uint32_t>(get(header + 52, 4));
+    return true;
+}
+
+// seconds since the epoch, 0 if unknown
+std::int64_t modified_time(const std::string &file_path)
+{
+#ifdef NZS_HAS_MMAP
+    struct stat info;
+    if (::stat(file_path.c_str(), &info) == 0)
+    {
+        return static_cast<std::int64_t>(info.st_mtime);
+    }
+#else
+    (void)file_path;
+#endif
+    return 0;
+}
+
+// flush the file (or the directory) to the disk; a checkpoint replaces the
+// previous one only after its data is on the disk, and the rename is made
+// durable by syncing the directory; a no-op where fsync is not available
+bool sync_path(const std::string &path)
+{
+#ifdef NZS_HAS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+#else
+    (void)path;
+    return true;
+#endif
+}
+
+std::string directory_of(const std::string &file_path)
+{
+    std::size_t slash = file_path.find_last_of('/');
+    if (slash == std::string::npos)
+    {
+        return ".";
+    }
+    return slash == 0 ? "/" : file_path.substr(0, slash);
+}
+
+std::string slot_path(const CheckpointPolicy &policy, std::size_t slot)
+{
+    return policy.prefix + "." + std::to_string(slot) + ".gol";
+}
+
+struct SlotInfo
+{
+    std::size_t slot;
+    std::uint32_t sequence;
+    std::int64_t time;
+};
+
+// the slots with a checkpoint header from the newest; the newest is the last
+// written one (the highest sequence number, the modification time for the files
+// of the same number), not the largest generation, which restarts after a clear()
+std::vector<SlotInfo> written_slots(const CheckpointPolicy &policy)
+{
+    std::vector<SlotInfo> slots;
+    for (std::size_t slot = 0; slot < policy.keep; ++slot)
+    {
+        std::string file_path = slot_path(policy, slot);
+        std::uint32_t slot_sequence;
+        if (read_sequence(file_path, slot_sequence))
+        {
+            slots.push_back(SlotInfo{slot, slot_sequence, modified_time(file_path)});
+        }
+    }
+    std::sort(slots.begin(), slots.end(), [](const SlotInfo & a, const SlotInfo & b)
+    {
+        return a.sequence != b.sequence ? a.sequence > b.sequence : a.time > b.time;
+    });
+    return slots;
+}
+
+} // anonymous
+
+Checkpoint make_checkpoint(const GameOfLife &game)
+{
+    return Checkpoint{game.grid(), game.generation(), game.is_bounded(), game.get_rule()};
+}
+
+void restore(GameOfLife &game, Checkpoint checkpoint)
+{
+    game.restore(std::move(checkpoint.grid), checkpoint.generation);
+    game.set_rule(checkpoint.rule);
+    if (game.is_bounded() != checkpoint.bounded)
+    {
+        game.toggle_boundary();
+    }
+}
+
+bool save_checkpoint(const std::string &file_path, const Checkpoint &checkpoint, bool compressed,
+                     std::uint32_t sequence)
+{
+    // a crash while writing leaves the previous file intact
+    std::string temp_path = file_path + ".tmp";
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        Log::error("cannot open file:", temp_path);
+        return false;
+    }
+
+    // the header is written after the payload, when its size is known
+    std::uint8_t header[header_size] = {};
+    file.write(reinterpret_cast<const char *>(header), header_size);
+
+    const BitGrid &grid = checkpoint.grid;
+    const std::size_t count = grid.words_per_row() * grid.get_height();
+    const BitGrid::word_type *words = grid.row(0);
+    std::uint64_t checksum = checksum_seed;
+    std::uint64_t population = 0;
+    PayloadWriter payload(file);
+    if (!compressed)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            checksum = mix(checksum, words[i]);
+            population += details::popcount(words[i]);
+            payload.push(words[i]);
+        }
+    }
+    else
+    {
+        std::size_t i = 0;
+        while (i < count)
+        {
+            std::uint64_t zeros = 0;
+            while (i < count && words[i] == 0 && zeros < 0xffffffffull)
+            {
+                checksum = mix(checksum, 0);
+                ++zeros;
+                ++i;
+            }
+            std::size_t first = i;
+            while (i < count && words[i] != 0 && i - first < 0xffffffffull)
+            {
+                checksum = mix(checksum, words[i]);
+                population += details::popcount(words[i]);
+                ++i;
+            }
+            payload.push(zeros | (std::uint64_t(i - first) << 32));
+            for (std::size_t j = first; j < i; ++j)
+            {
+                payload.push(words[j]);
+            }
+        }
+    }
+    payload.flush();
+
+    std::uint8_t trailer[checksum_size];
+    put(trailer, checksum, checksum_size);
+    file.write(reinterpret_cast<const char *>(trailer), checksum_size);
+
+    std::memcpy(header, magic, sizeof(magic));
+    put(header + 8, format_version, 4);
+    put(header + 12, (checkpoint.bounded ? flag_bounded : 0) | (compressed ? flag_compressed : 0), 4);
+    put(header + 16, grid.get_width(), 8);
+    put(header + 24, grid.get_height(), 8);
+    put(header + 32, checkpoint.generation, 8);
+    put(header + 40, population, 8);
+    put(header + 48, checkpoint.rule.birth(), 2);
+    put(header + 50, checkpoint.rule.survival(), 2);
+    put(header + 52, sequence, 4);
+    put(header + 56, payload.size(), 8);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(header), header_size);
+    file.close();
+    if (!file || !sync_path(temp_path))
+    {
+        Log::error("cannot write file:", temp_path);
+        std::remove(temp_path.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    // rename does not replace an existing file
+    std::remove(file_path.c_str());
+#endif
+    if (std::rename(temp_path.c_str(), file_path.c_str()) != 0)
+    {
+        Log::error("cannot rename", temp_path, "to", file_path);
+        return false;
+    }
+    if (!sync_path(directory_of(file_path)))
+    {
+        Log::warning("cannot sync the directory of", file_path);
+    }
+    Log::debug("checkpoint saved:", file_path, "generation:", checkpoint.generation);
+    return true;
+}
+
+bool load_checkpoint(const std::string &file_path, Checkpoint &checkpoint)
+{
+    MappedFile file(file_path);
+    Header header;
+    if (!read_header(file, file_path, header))
+    {
+        return false;
+    }
+
+    // the bounds leave the allocation possible, not certain
+    BitGrid grid(0, 0);
+    std::size_t count = 0;
+    bool decoded = false;
+    try
+    {
+        grid = BitGrid(static_cast<std::size_t>(header.width), static_cast<std::size_t>(header.height));
+        count = grid.words_per_row() * grid.get_height();
+        decoded = decode(file.data() + header_size, header.payload_size, header.compressed,
+                         grid.row(0), count);
+    }
+    catch (const std::exception &)
+    {
+        Log::error("broken checkpoint header:", file_path);
+        return false;
+    }
+    if (!decoded)
+    {
+        Log::error("broken checkpoint payload:", file_path);
+        return false;
+    }
+
+    std::uint64_t checksum = checksum_seed;
+    const BitGrid::word_type *words = grid.row(0);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        checksum = mix(checksum, words[i]);
+    }
+    if (checksum != header.checksum)
+    {
+        Log::error("checkpoint checksum mismatch:", file_path);
+        return false;
+    }
+    // no cell outside of the grid
+    for (std::size_t y = 0; y < grid.get_height() && grid.words_per_row() != 0; ++y)
+    {
+        grid.row(y)[grid.words_per_row() - 1] &= grid.tail_mask();
+    }
+    if (header.population != grid.count())
+    {
+        Log::error("checkpoint population mismatch:", file_path);
+        return false;
+    }
+
+    checkpoint = Checkpoint{std::move(grid), static_cast<std::size_t>(header.generation),
+                            header.bounded, Rule(header.birth, header.survival)};
+    Log::debug("checkpoint loaded:", file_path, "generation:", header.generation);
+    return true;
+}
+
+CheckpointWriter::CheckpointWriter() :
+    busy_(0),
+    stop_(false)
+{
+    thread_ = std::thread(&CheckpointWriter::loop, this);
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void CheckpointWriter::write(std::string file_path, Checkpoint checkpoint, bool compressed,
+                             std::uint32_t sequence)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(Job{std::move(file_path), std::move(checkpoint), compressed, sequence});
+    }
+    wake_.notify_one();
+}
+
+void CheckpointWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]()
+    {
+        return jobs_.empty() && busy_ == 0;
+    });
+}
+
+std::size_t CheckpointWriter::pending()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.size() + busy_;
+}
+
+void CheckpointWriter::loop()
+{
+    std::deque<Job> jobs;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this]()
+            {
+                return stop_ || !jobs_.empty();
+            });
+            // the queued checkpoints are written before stopping
+            if (jobs_.empty())
+            {
+                return;
+            }
+            jobs.swap(jobs_);
+            busy_ = jobs.size();
+        }
+
+        for (const auto &job : jobs)
+        {
+            save_checkpoint(job.file_path, job.checkpoint, job.compressed, job.sequence);
+        }
+        jobs.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_ = 0;
+        }
+        done_.notify_all();
+    }
+}
+
+std::string latest_checkpoint(const CheckpointPolicy &policy)
+{
+    // the broken files are skipped, the chosen one is decoded only by its loader
+    for (const auto &info : written_slots(policy))
+    {
+        std::string file_path = slot_path(policy, info.slot);
+        if (check_checkpoint(file_path))
+        {
+            return file_path;
+        }
+        Log::warning("skipping the broken checkpoint:", file_path);
+    }
+    return std::string();
+}
+
+AutoCheckpoint::AutoCheckpoint(const CheckpointPolicy &policy) :
+    policy_(policy),
+    slot_(0),
+    sequence_(0),
+    started_(false),
+    last_generation_(0),
+    last_time_(clock_type::now())
+{
+    // continue after the last written file, read from the headers only
+    std::vector<SlotInfo> slots = written_slots(policy_);
+    if (!slots.empty())
+    {
+        slot_ = (slots.front().slot + 1) % policy_.keep;
+        sequence_ = slots.front().sequence;
+    }
+    ++sequence_;
+}
+
+void AutoCheckpoint::update(const GameOfLife &game)
+{
+    if (!policy_.enabled())
+    {
+        return;
+    }
+
+    auto now = clock_type::now();
+    std::size_t generation = game.generation();
+    if (!started_)
+    {
+        started_ = true;
+        last_generation_ = generation;
+        last_time_ = now;
+        return;
+    }
+
+    // clear() restarts the generations
+    bool due = generation != last_generation_ &&
+               (generation < last_generation_ ||
+                (policy_.generations != 0 && generation - last_generation_ >= policy_.generations) ||
+                (policy_.seconds.count() != 0 && now - last_time_ >= policy_.seconds));
+    if (!due || writer_.pending() != 0)
+    {
+        return;
+    }
+
+    NZS_LOG_VERBOSE("auto checkpoint, generation:", generation, "slot:", slot_);
+    writer_.write(slot_path(policy_, slot_), make_checkpoint(game), true, sequence_++);
+    slot_ = (slot_ + 1) % policy_.keep;
+    last_generation_ = generation;
+    last_time_ = now;
+}
+
+} // gol
+
+} // nzs
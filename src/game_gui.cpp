@@ -1,8 +1,11 @@
 #include "game_gui.hpp"
+#include "pattern_io.hpp"
 #include "log.hpp"
 
 #include <chrono>
 #include <thread>
+#include <cstdio>
+#include <algorithm>
 
 namespace nzs
 {
@@ -11,16 +14,48 @@ namespace gol
 {
 
 GameGui::GameGui(std::size_t window_width, std::size_t window_height,
-                 std::size_t row, std::size_t column, bool full_screen):
-    game_table_(row, column),
+                 std::size_t row, std::size_t column, bool full_screen,
+                 std::size_t threads, const Rule &rule,
+                 const std::string &pattern, const std::vector<std::string> &brush_files,
+                 const CheckpointPolicy &autosave):
+    simulation_(row, column),
+    snapshot_(&simulation_.snapshot()),
     window_width_(window_width),
     window_height_(window_height),
     full_screen_(full_screen),
     wait_next_iter_(std::chrono::milliseconds(200)),
     call_next_iter_(false),
-    first_left_click_is_alive_(false)
+    max_speed_(false),
+    shown_rate_(0.0),
+    first_left_click_is_alive_(false),
+    show_timers_(false),
+    shown_seconds_(1.0),
+    timers_time_(std::chrono::steady_clock::now())
 {
+    set_timing(true);
+    simulation_.post([threads, rule](GameOfLife & game)
+    {
+        game.set_threads(threads);
+        game.set_rule(rule);
+    });
+    if (!pattern.empty())
+    {
+        simulation_.post([pattern](GameOfLife & game)
+        {
+            load_board(pattern, game);
+        });
+    }
+    simulation_.set_autosave(autosave);
     BrushTool::load_from_file("./brushs.txt", brushs_);
+    for (const auto &file : brush_files)
+    {
+        Brush cells;
+        PatternInfo info;
+        if (load_pattern(file, cells, info))
+        {
+            brushs_.add(centered(cells, info));
+        }
+    }
     brushs_.use(1);
 }
 
@@ -32,30 +67,60 @@ void GameGui::run()
         return;
     }
     Log::debug("successful initialization");
+    set_thread_name("window");
+
+    // the phases of a frame, GameOfLife::next() is timed on the simulation thread
+    Histogram &frame_timer = get_timer("GameGui::frame");
+    Histogram &update_timer = get_timer("GameGui::update");
+    Histogram &draw_timer = get_timer("GameGui::draw");
+    Histogram &sleep_timer = get_timer("GameGui::sleep");
+    Histogram &swap_timer = get_timer("glfwSwapBuffers");
+    Histogram &poll_timer = get_timer("glfwPollEvents");
 
     using frame_duration = std::chrono::duration<int, std::ratio<1, 60>>;
     while (!glfwWindowShouldClose(window_.get()))
     {
-        auto start_time = std::chrono::high_resolution_clock::now();
+        ScopedTimer frame(frame_timer);
+        auto start_time = std::chrono::steady_clock::now();
 
-        update();
-        draw();
-
-        auto end_time = start_time + frame_duration(1);
-        std::this_thread::sleep_until(end_time);
-
-        glfwSwapBuffers(window_.get());
-        glfwPollEvents();
+        // the latest generation of the simulation thread
+        snapshot_ = &simulation_.snapshot();
+        {
+            ScopedTimer scope(update_timer);
+            ScopedTrace trace("update", "window");
+            update();
+        }
+        {
+            ScopedTimer scope(draw_timer);
+            ScopedTrace trace("draw", "render", "generation", static_cast<std::int64_t>(snapshot_->generation));
+            draw();
+        }
+        {
+            ScopedTimer scope(sleep_timer);
+            std::this_thread::sleep_until(start_time + frame_duration(1));
+        }
+        {
+            ScopedTimer scope(swap_timer);
+            ScopedTrace trace("swap buffers", "render");
+            glfwSwapBuffers(window_.get());
+        }
+        {
+            ScopedTimer scope(poll_timer);
+            ScopedTrace trace("poll events", "input");
+            glfwPollEvents();
+        }
     }
 }
 
 bool GameGui::init()
 {
     // create window
+    renderer_ = nullptr; // free the GL objects before their context
     window_ = nullptr; // destroy previous window if exists
     window_ = make_window(window_width_, window_height_, "Game of Life",
                           full_screen_ ? glfwGetPrimaryMonitor() : nullptr, nullptr);
     Log::verbose("window created");
+    shown_rate_ = 0.0;
 
     // init OpenGL
     glClearColor(1, 1, 1, 1);
@@ -66,41 +131,34 @@ bool GameGui::init()
     glViewport(0, 0, window_width_, window_height_);
     glOrtho(0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f);
 
+    renderer_.reset(new GridRenderer());
+
     return true;
 }
 
 void GameGui::update()
 {
-    // next iteration calculation
-    static auto now = std::chrono::system_clock::now();
-    if (std::chrono::system_clock::now() - now >= wait_next_iter_)
-    {
-        if (call_next_iter_)
-        {
-            game_table_.next();
-            Log::verbose("generation:", game_table_.generation(),
-                         "population:", game_table_.population());
-        }
-        now = std::chrono::system_clock::now();
-    }
-
     // mouse handling
     int left_click = glfwGetMouseButton(window_.get(), GLFW_MOUSE_BUTTON_1);
     if (left_click == GLFW_PRESS)
     {
-        const auto &brush = brushs_.get();
+        Brush brush = brushs_.get();
         Position index = mouse_to_index();
-        for (const auto &pos_offset : brush)
+        bool alive = first_left_click_is_alive_;
+        simulation_.post([brush, index, alive](GameOfLife & game)
         {
-            if (first_left_click_is_alive_)
-            {
-                game_table_.born(index + pos_offset);
-            }
-            else
+            for (const auto &pos_offset : brush)
             {
-                game_table_.kill(index + pos_offset);
+                if (alive)
+                {
+                    game.born(index + pos_offset);
+                }
+                else
+                {
+                    game.kill(index + pos_offset);
+                }
             }
-        }
+        });
     }
 
     // set the actual brush to an empty one
@@ -110,28 +168,68 @@ void GameGui::update()
         brushs_.use(0);
     }
 
+    // show the speed of the simulation, the snapshot is updated twice a second
+    if (snapshot_->generations_per_second != shown_rate_)
+    {
+        shown_rate_ = snapshot_->generations_per_second;
+        std::string title = "Game of Life";
+        if (shown_rate_ > 0.0)
+        {
+            title += " - " + std::to_string(static_cast<long long>(shown_rate_ + 0.5)) +
+                     " generations/s";
+        }
+        glfwSetWindowTitle(window_.get(), title.c_str());
+    }
+
+    update_timers();
+}
+
+void GameGui::update_timers()
+{
+    auto now = std::chrono::steady_clock::now();
+    if (now - timers_time_ < std::chrono::milliseconds(500))
+    {
+        return;
+    }
+    shown_seconds_ = std::chrono::duration<double>(now - timers_time_).count();
+    timers_time_ = now;
+
+    auto timers = all_timers();
+    timer_counts_.resize(timers.size(), TimerCounts());
+    shown_timers_.clear();
+    for (std::size_t i = 0; i < timers.size(); ++i)
+    {
+        TimerCounts counts = timers[i]->counts();
+        shown_timers_.push_back(summarize(timers[i]->name(), difference(counts, timer_counts_[i])));
+        timer_counts_[i] = counts;
+    }
 }
 
 void GameGui::draw()
 {
     glClear(GL_COLOR_BUFFER_BIT);
 
-    // draw grid
-    glColor4f(0.6, 0.6, 0.6, 0.3);
-    details::draw_grid(game_table_.get_width(), game_table_.get_height());
+    const BitGrid &grid = snapshot_->grid;
+    float width = 1.f / grid.get_width();
+    float height = 1.f / grid.get_height();
 
-    // draw alive cells
-    glColor4f(0.6f, 1.f, 0.6f, 1.f);
-    float width = 1.f / game_table_.get_width();
-    float height = 1.f / game_table_.get_height();
-
-    for (unsigned i = 0; i < game_table_.get_width(); ++i)
+    // the cells and the grid in one quad, or quad by quad without shaders
+    if (!renderer_->draw(grid, snapshot_->version))
     {
-        for (unsigned j = 0; j < game_table_.get_height(); ++j)
+        // draw grid
+        glColor4f(0.6, 0.6, 0.6, 0.3);
+        details::draw_grid(grid.get_width(), grid.get_height());
+
+        // draw alive cells
+        glColor4f(0.6f, 1.f, 0.6f, 1.f);
+        for (unsigned i = 0; i < grid.get_width(); ++i)
         {
-            if (game_table_[i][j] == true)
+            for (unsigned j = 0; j < grid.get_height(); ++j)
             {
-                details::draw_quad(i * width, j * height, width, height);
+                if (grid.get(i, j))
+                {
+                    details::draw_quad(i * width, j * height, width, height);
+                }
             }
         }
     }
@@ -145,18 +243,65 @@ void GameGui::draw()
         auto tmp = index + pos_offset;
         details::draw_quad(tmp.get_x() * width, tmp.get_y() * height, width, height);
     }
+
+    if (show_timers_)
+    {
+        draw_timers();
+    }
+}
+
+void GameGui::draw_timers()
+{
+    // a glyph pixel is 2x2 screen pixels, a line is 7 glyph pixels high
+    float pixel_width = 2.f / window_width_;
+    float pixel_height = 2.f / window_height_;
+    float line = 7 * pixel_height;
+    float left = 2 * pixel_width;
+    // the bars are relative to the 16.7 ms of a frame
+    float bar_left = left + 42 * 4 * pixel_width;
+    float bar_width = 60 * 4 * pixel_width;
+    double budget = 1e9 / 60;
+
+    glColor4f(0.f, 0.f, 0.f, 0.7f);
+    details::draw_quad(0, 0, bar_left + bar_width + left, (shown_timers_.size() + 1) * line + 2 * pixel_height);
+
+    glColor4f(1.f, 1.f, 1.f, 1.f);
+    details::draw_text(left, pixel_height, pixel_width, pixel_height,
+                       "phase                  /s    mean ms   p99 ms");
+    for (std::size_t i = 0; i < shown_timers_.size(); ++i)
+    {
+        const TimerSummary &timer = shown_timers_[i];
+        float top = (i + 1) * line + pixel_height;
+
+        char text[64];
+        std::snprintf(text, sizeof(text), "%-18.18s %7llu %9.3f %8.3f", timer.name.c_str(),
+                      static_cast<unsigned long long>(timer.count / shown_seconds_ + 0.5), timer.mean / 1e6, timer.p99 / 1e6);
+        glColor4f(1.f, 1.f, 1.f, 1.f);
+        details::draw_text(left, top, pixel_width, pixel_height, text);
+
+        // the mean as a bar, the 99th percentile as a thin mark
+        float mean = std::min(timer.mean / budget, 1.0) * bar_width;
+        float p99 = std::min(timer.p99 / budget, 1.0) * bar_width;
+        glColor4f(0.4f, 0.9f, 0.4f, 1.f);
+        details::draw_quad(bar_left, top, mean, 5 * pixel_height);
+        glColor4f(1.f, 0.4f, 0.3f, 1.f);
+        details::draw_quad(bar_left + p99, top, pixel_width, 5 * pixel_height);
+    }
 }
 
-void GameGui::mouse_button_callback(GLFWwindow *, int /*button*/, int action, int /*mods*/)
+void GameGui::mouse_button_callback(GLFWwindow *, int button, int action, int /*mods*/)
 {
+    ScopedTrace trace("mouse button", "input", "button", button);
     if (action == GLFW_PRESS)
     {
-        first_left_click_is_alive_ = !game_table_.is_alive(mouse_to_index());
+        Position index = mouse_to_index();
+        first_left_click_is_alive_ = !snapshot_->grid.get(index.get_x(), index.get_y());
     }
 }
 
-void GameGui::keyboard_callback(GLFWwindow *, int key, int, int action, int)
+void GameGui::keyboard_callback(GLFWwindow *, int key, int, int action, int mods)
 {
+    ScopedTrace trace("key", "input", "key", key);
     if (key == GLFW_KEY_ESCAPE && action == GLFW_RELEASE)
     {
         Log::debug("exit");
@@ -165,17 +310,26 @@ void GameGui::keyboard_callback(GLFWwindow *, int key, int, int action, int)
     if (key == GLFW_KEY_N && action == GLFW_RELEASE)
     {
         Log::debug("call next iteration");
-        game_table_.next();
+        simulation_.post([](GameOfLife & game)
+        {
+            game.next();
+        });
     }
     if (key == GLFW_KEY_R && action == GLFW_RELEASE)
     {
         Log::debug("clear the grid");
-        game_table_.clear();
+        simulation_.post([](GameOfLife & game)
+        {
+            game.clear();
+        });
     }
     if (key == GLFW_KEY_B && action == GLFW_RELEASE)
     {
         Log::debug("boundary toogled");
-        game_table_.toggle_boundary();
+        simulation_.post([](GameOfLife & game)
+        {
+            game.toggle_boundary();
+        });
     }
     if (key == GLFW_KEY_F && action == GLFW_RELEASE)
     {
@@ -188,39 +342,104 @@ void GameGui::keyboard_callback(GLFWwindow *, int key, int, int action, int)
         // speed up the iteration
         Log::debug("speed up the iteration");
         wait_next_iter_ -= std::chrono::milliseconds(25);
+        simulation_.set_interval(wait_next_iter_);
     }
     if (key == GLFW_KEY_KP_SUBTRACT && action == GLFW_RELEASE)
     {
         // slow down the iteration
         Log::debug("slow down the iteration");
         wait_next_iter_ += std::chrono::milliseconds(25);
+        simulation_.set_interval(wait_next_iter_);
     }
     if (key == GLFW_KEY_SPACE && action == GLFW_RELEASE)
     {
         // play/stop the iteration
-        Log::debug("playing:", call_next_iter_ ? "true" : "false");
         call_next_iter_ = ! call_next_iter_;
+        Log::debug("playing:", call_next_iter_ ? "true" : "false");
+        simulation_.set_running(call_next_iter_);
+    }
+    if (key == GLFW_KEY_S && action == GLFW_RELEASE)
+    {
+        Log::debug("save the grid");
+        simulation_.post([](GameOfLife & game)
+        {
+            if (save_rle("./board.rle", game))
+            {
+                Log::debug("grid saved: ./board.rle");
+            }
+        });
+    }
+    if (key == GLFW_KEY_C && action == GLFW_RELEASE)
+    {
+        // the copy is written in the background
+        Log::debug("save a checkpoint");
+        simulation_.post([this](GameOfLife & game)
+        {
+            checkpoints_.write("./checkpoint.gol", make_checkpoint(game));
+        });
+    }
+    if (key == GLFW_KEY_BACKSPACE && (action == GLFW_PRESS || action == GLFW_REPEAT))
+    {
+        // one generation back, a hundred with control, held down it keeps going back
+        std::size_t steps = (mods & GLFW_MOD_CONTROL) ? 100 : 1;
+        Log::debug("rewind", steps, "generations");
+        simulation_.rewind(steps);
+    }
+    if (key == GLFW_KEY_M && action == GLFW_RELEASE)
+    {
+        // as many generations as fit in a frame
+        max_speed_ = !max_speed_;
+        Log::debug("max speed:", max_speed_ ? "true" : "false");
+        simulation_.set_max_speed(max_speed_);
+    }
+    if (key == GLFW_KEY_T && action == GLFW_RELEASE)
+    {
+        show_timers_ = !show_timers_;
+        Log::debug("timing overlay:", show_timers_ ? "true" : "false");
+    }
+    if (key == GLFW_KEY_P && action == GLFW_RELEASE)
+    {
+        // the first press starts a new trace, the second one writes it
+        if (!tracing_enabled())
+        {
+            Log::debug("tracing started");
+            clear_trace();
+            set_tracing(true);
+        }
+        else
+        {
+            set_tracing(false);
+            if (write_trace("./trace.json"))
+            {
+                Log::debug("trace saved: ./trace.json");
+            }
+            else
+            {
+                Log::error("cannot write file: ./trace.json");
+            }
+        }
     }
 }
 
 void GameGui::scroll_callback(GLFWwindow *, double , double yoffset)
 {
+    ScopedTrace trace("scroll", "input");
     // resize the grid
     if (glfwGetKey(window_.get(), GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS)
     {
         Log::debug("resize the grid");
-        if (yoffset < 0)
+        // relative to the size at the time of the command, the snapshot may be late
+        simulation_.post([yoffset](GameOfLife & game)
         {
-            game_table_.resize(game_table_.get_width() + 1, game_table_.get_height() + 1);
-        }
-        else
-        {
-            if (game_table_.get_width() < 2 || game_table_.get_height() < 2)
+            if (yoffset < 0)
             {
-                return;
+                game.resize(game.get_width() + 1, game.get_height() + 1);
             }
-            game_table_.resize(game_table_.get_width() - 1, game_table_.get_height() - 1);
-        }
+            else if (game.get_width() >= 2 && game.get_height() >= 2)
+            {
+                game.resize(game.get_width() - 1, game.get_height() - 1);
+            }
+        });
     }
     // next/previous brush
     else
@@ -240,6 +459,7 @@ void GameGui::scroll_callback(GLFWwindow *, double , double yoffset)
 
 void GameGui::frame_buffer_callback(GLFWwindow *, int width, int height)
 {
+    ScopedTrace trace("resize", "input");
     window_width_ = width;
     window_height_ = height;
     glViewport(0, 0, window_width_, window_height_);
@@ -250,16 +470,18 @@ Position GameGui::mouse_to_index() const
     double mouse_x, mouse_y;
     glfwGetCursorPos(window_.get(), &mouse_x, &mouse_y);
 
-    double width = window_width_ / game_table_.get_width();
-    double height = window_height_ / game_table_.get_height();
+    std::size_t columns = snapshot_->grid.get_width();
+    std::size_t rows = snapshot_->grid.get_height();
+    double width = window_width_ / columns;
+    double height = window_height_ / rows;
 
     Position index;
     index.set_x(mouse_x / width);
     index.set_y(mouse_y / height);
 
-    if (index.get_x() >= (int)game_table_.get_width())
+    if (index.get_x() >= (int)columns)
     {
-        index.set_x(game_table_.get_width() - 1);
+        index.set_x(columns - 1);
     }
 
     if (index.get_x() < 0)
@@ -267,9 +489,9 @@ Position GameGui::mouse_to_index() const
         index.set_x(0);
     }
 
-    if (index.get_y() >= (int)game_table_.get_height())
+    if (index.get_y() >= (int)rows)
     {
-        index.set_y(game_table_.get_height() - 1);
+        index.set_y(rows - 1);
     }
 
     if (index.get_y() < 0)
@@ -1,20 +1,49 @@
 #include "game_of_life.hpp"
+#include "life_kernel.hpp"
+#include "timing.hpp"
+#include "trace.hpp"
 #include "cpp_features.hpp"
 
+#include <stdexcept>
+
 namespace nzs
 {
 
 namespace gol
 {
 
-GameOfLife::GameOfLife(std::size_t width, std::size_t height) :
+const std::size_t GameOfLife::tile_rows;
+const std::size_t GameOfLife::tile_words;
+const std::size_t GameOfLife::seen_size;
+const std::size_t GameOfLife::seen_probes;
+
+namespace
+{
+
+// smaller grids are not worth the thread synchronization
+const std::size_t min_parallel_words = 1 << 12;
+
+} // anonymous
+
+GameOfLife::GameOfLife(std::size_t width, std::size_t height, Engine engine) :
     width_(width),
     height_(height),
     generation_(0),
     population_(0),
+    version_(0),
     bounded_(false),
-    grid_(width, row_type(height, false))
+    engine_(engine),
+    grid_(width, height),
+    back_grid_(width, height),
+    tiles_x_(0),
+    tiles_y_(0),
+    hash_(0),
+    seen_(seen_size, SeenState{0, 0, 0}),
+    epoch_(1),
+    period_(0),
+    stats_{0, 0}
 {
+    reset_tiles();
 }
 
 void GameOfLife::kill(const Position &pos)
@@ -22,7 +51,13 @@ void GameOfLife::kill(const Position &pos)
     if (is_valid_position(pos) && is_alive(pos))
     {
         --population_;
-        grid_[pos.get_x()][pos.get_y()] = false;
+        ++version_;
+        auto old_word = grid_.row(pos.get_y())[pos.get_x() / BitGrid::word_bits];
+        grid_.set(pos.get_x(), pos.get_y(), false);
+        changed_[tile_of(pos)] = 1;
+        tile_version_[tile_of(pos)] = version_;
+        --tile_population_[tile_of(pos)];
+        rehash_word(pos.get_x(), pos.get_y(), old_word);
     }
 }
 
@@ -31,7 +66,13 @@ void GameOfLife::born(const Position &pos)
     if (is_valid_position(pos) && !is_alive(pos))
     {
         ++population_;
-        grid_[pos.get_x()][pos.get_y()] = true;
+        ++version_;
+        auto old_word = grid_.row(pos.get_y())[pos.get_x() / BitGrid::word_bits];
+        grid_.set(pos.get_x(), pos.get_y(), true);
+        changed_[tile_of(pos)] = 1;
+        tile_version_[tile_of(pos)] = version_;
+        ++tile_population_[tile_of(pos)];
+        rehash_word(pos.get_x(), pos.get_y(), old_word);
     }
 }
 
@@ -54,80 +95,315 @@ void GameOfLife::flip(const Position &pos)
 
 void GameOfLife::next(std::size_t iteration)
 {
+    static Histogram &timer = get_timer("GameOfLife::next");
+    ScopedTimer scope(timer);
+
+    stats_ = {0, 0};
+    // the state before the first step counts as well
+    remember_state();
     for (std::size_t i = 0; i < iteration; i++)
     {
-        std::vector<Position> has_to_die;
-        std::vector<Position> has_to_born;
-        has_to_die.reserve(population_ / 2);
-        has_to_born.reserve(population_ / 2);
-
-        for (std::size_t x = 0; x < width_; ++x)
-        {
-            for (std::size_t y = 0; y < height_; ++y)
-            {
-                Position pos(x, y);
-                auto alive_neigbors = get_alive_neighbors(pos);
-                auto cell_is_alive  = is_alive(pos);
-                if (cell_is_alive && (alive_neigbors < 2 || alive_neigbors > 3))
-                {
-                    has_to_die.push_back(pos);
-                }
-                else if (alive_neigbors == 3 && !cell_is_alive)
-                {
-                    has_to_born.push_back(pos);
-                }
-            }
-        }
-
-        for (const auto &cell : has_to_die)
+        ScopedTrace trace("generation", "simulation", "generation", static_cast<std::int64_t>(generation_));
+        if (engine_ == Engine::bitwise)
         {
-            kill(cell);
+            next_bitwise();
         }
-
-        for (const auto &cell : has_to_born)
+        else
         {
-            born(cell);
+            next_reference();
         }
 
         ++generation_;
+        ++version_;
+        remember_state();
     }
 }
 
 void GameOfLife::clear()
 {
     grid_.clear();
-    grid_.resize(width_, row_type(height_, false));
     generation_ = 0;
     population_ = 0;
+    ++version_;
+    reset_tiles();
 }
 
 void GameOfLife::resize(std::size_t width, std::size_t height)
 {
-    grid_type grid_tmp(width, row_type(height, false));
-    auto min_w = std::min(width_, width);
-    auto min_h = std::min(height_, height);
+    grid_.resize(width, height);
+    back_grid_ = BitGrid(width, height);
+
+    width_ = width;
+    height_ = height;
+    population_ = grid_.count();
+    ++version_;
+    reset_tiles();
+}
+
+void GameOfLife::restore(BitGrid grid, std::size_t generation)
+{
+    width_ = grid.get_width();
+    height_ = grid.get_height();
+    grid_.swap(grid);
+    back_grid_ = BitGrid(width_, height_);
+
+    generation_ = generation;
+    population_ = grid_.count();
+    ++version_;
+    reset_tiles();
+}
 
+bool GameOfLife::is_alive(const Position &pos) const
+{
+    if (!is_valid_position(pos))
+    {
+        throw std::out_of_range("GameOfLife::is_alive");
+    }
+    return grid_.get(pos.get_x(), pos.get_y());
+}
+
+void GameOfLife::next_reference()
+{
+    // the next generation goes to the back grid, so every cell is visited once
     population_ = 0;
-    for (std::size_t i = 0; i < min_w; ++i)
+    std::fill(tile_population_.begin(), tile_population_.end(), 0);
+    for (std::size_t y = 0; y < height_; ++y)
     {
-        for (std::size_t j = 0; j < min_h; ++j)
+        for (std::size_t x = 0; x < width_; ++x)
         {
-            grid_tmp[i][j] = grid_[i][j];
-            if (grid_tmp[i][j])
+            Position pos(x, y);
+            auto alive_neigbors = get_alive_neighbors(pos);
+            bool alive = rule_.next(grid_.get(x, y), alive_neigbors);
+            back_grid_.set(x, y, alive);
+            if (alive)
             {
                 ++population_;
+                ++tile_population_[tile_of(pos)];
             }
         }
     }
+    grid_.swap(back_grid_);
 
-    width_ = width;
-    height_ = height;
-    grid_ = std::move(grid_tmp);
+    // the changes are not tracked per tile here, next() makes version_ + 1
+    mark_all_changed();
+    std::fill(tile_version_.begin(), tile_version_.end(), version_ + 1);
+    hash_ = 0;
+    for (std::size_t tile_y = 0; tile_y < tiles_y_; ++tile_y)
+    {
+        for (std::size_t tile_x = 0; tile_x < tiles_x_; ++tile_x)
+        {
+            tile_hash_[tile_y * tiles_x_ + tile_x] = tile_hash(grid_, tile_x, tile_y);
+            hash_ ^= tile_hash_[tile_y * tiles_x_ + tile_x];
+        }
+    }
 }
 
-bool GameOfLife::is_alive(const Position &pos) const
+void GameOfLife::set_threads(std::size_t threads)
+{
+    pool_.reset();
+    if (threads != 1)
+    {
+        pool_.reset(new ThreadPool(threads));
+    }
+}
+
+void GameOfLife::next_bitwise()
+{
+    stats_.tiles += tiles_x_ * tiles_y_;
+    stats_.stepped_tiles += mark_active_tiles();
+
+    // the inactive tiles of the back grid hold the same cells as the front grid
+    std::size_t words = grid_.words_per_row();
+    auto step_tile_row = [&](std::size_t tile_y)
+    {
+        ScopedTrace trace("tile row", "simulation", "row", static_cast<std::int64_t>(tile_y));
+        std::size_t first_row = tile_y * tile_rows;
+        std::size_t last_row = std::min(first_row + tile_rows, height_);
+        for (std::size_t tile_x = 0; tile_x < tiles_x_; ++tile_x)
+        {
+            std::size_t tile = tile_y * tiles_x_ + tile_x;
+            if (!active_[tile])
+            {
+                continue;
+            }
+
+            std::size_t first_word = tile_x * tile_words;
+            std::size_t last_word = std::min(first_word + tile_words, words);
+            auto result = details::step_bitwise(grid_, back_grid_, rule_, bounded_,
+                                                first_row, last_row, first_word, last_word);
+            changed_[tile] = result.changed;
+            tile_population_[tile] = result.population;
+            if (result.changed)
+            {
+                tile_hash_[tile] = tile_hash(back_grid_, tile_x, tile_y);
+                // the version of the new generation, next() makes it after the step
+                tile_version_[tile] = version_ + 1;
+            }
+        }
+    };
+
+    // every tile row reads the front grid and writes only its own part of the back grid
+    if (pool_ && tiles_y_ > 1 && height_ * words >= min_parallel_words)
+    {
+        pool_->run(tiles_y_, step_tile_row);
+    }
+    else
+    {
+        for (std::size_t tile_y = 0; tile_y < tiles_y_; ++tile_y)
+        {
+            step_tile_row(tile_y);
+        }
+    }
+
+    grid_.swap(back_grid_);
+    population_ = 0;
+    for (auto alive : tile_population_)
+    {
+        population_ += alive;
+    }
+    hash_ = 0;
+    for (auto tile : tile_hash_)
+    {
+        hash_ ^= tile;
+    }
+}
+
+void GameOfLife::reset_tiles()
+{
+    std::size_t tile_width = tile_words * BitGrid::word_bits;
+    tiles_x_ = (width_ + tile_width - 1) / tile_width;
+    tiles_y_ = (height_ + tile_rows - 1) / tile_rows;
+
+    changed_.assign(tiles_x_ * tiles_y_, 1);
+    active_.assign(tiles_x_ * tiles_y_, 0);
+    tile_version_.assign(tiles_x_ * tiles_y_, version_);
+    tile_population_.assign(tiles_x_ * tiles_y_, 0);
+    tile_hash_.assign(tiles_x_ * tiles_y_, 0);
+    hash_ = 0;
+    for (std::size_t tile_y = 0; tile_y < tiles_y_; ++tile_y)
+    {
+        for (std::size_t tile_x = 0; tile_x < tiles_x_; ++tile_x)
+        {
+            std::size_t tile = tile_y * tiles_x_ + tile_x;
+            std::size_t first_row = tile_y * tile_rows;
+            std::size_t first_word = tile_x * tile_words;
+            tile_population_[tile] =
+                grid_.count(first_row, std::min(first_row + tile_rows, height_),
+                            first_word, std::min(first_word + tile_words, grid_.words_per_row()));
+            tile_hash_[tile] = tile_hash(grid_, tile_x, tile_y);
+            hash_ ^= tile_hash_[tile];
+        }
+    }
+    forget_states();
+}
+
+std::uint64_t GameOfLife::tile_hash(const BitGrid &grid, std::size_t tile_x, std::size_t tile_y) const NOEXCEPT
+{
+    std::size_t words = grid.words_per_row();
+    std::size_t first_row = tile_y * tile_rows;
+    std::size_t last_row = std::min(first_row + tile_rows, height_);
+    std::size_t first_word = tile_x * tile_words;
+    std::size_t last_word = std::min(first_word + tile_words, words);
+
+    std::uint64_t hash = 0;
+    for (std::size_t y = first_row; y < last_row; ++y)
+    {
+        const BitGrid::word_type *row = grid.row(y);
+        for (std::size_t x = first_word; x < last_word; ++x)
+        {
+            hash ^= details::word_key(y * words + x, row[x]);
+        }
+    }
+    return hash;
+}
+
+void GameOfLife::rehash_word(std::size_t x, std::size_t y, BitGrid::word_type old_word) NOEXCEPT
 {
-    return grid_.at(pos.get_x()).at(pos.get_y());
+    std::size_t index = y * grid_.words_per_row() + x / BitGrid::word_bits;
+    std::uint64_t delta = details::word_key(index, old_word) ^
+                          details::word_key(index, grid_.row(y)[x / BitGrid::word_bits]);
+    hash_ ^= delta;
+    tile_hash_[(y / tile_rows) * tiles_x_ + x / (tile_words * BitGrid::word_bits)] ^= delta;
+    forget_states();
+}
+
+void GameOfLife::remember_state()
+{
+    // the states of a cycle can share a slot, so a few neighbor slots are tried
+    // and the oldest one is replaced, otherwise they would evict each other
+    SeenState *oldest = nullptr;
+    for (std::size_t i = 0; i < seen_probes; ++i)
+    {
+        SeenState &seen = seen_[(hash_ + i) % seen_size];
+        if (seen.epoch != epoch_)
+        {
+            if (!oldest || oldest->epoch == epoch_)
+            {
+                oldest = &seen;
+            }
+            continue;
+        }
+
+        if (seen.hash == hash_ && seen.generation != generation_)
+        {
+            // the same cells give the same future, so the board cycles from here;
+            // the period of the first repetition is kept
+            if (period_ == 0)
+            {
+                period_ = generation_ - seen.generation;
+            }
+            seen.generation = generation_;
+            return;
+        }
+        if (seen.hash == hash_)
+        {
+            return;
+        }
+        if (!oldest || (oldest->epoch == epoch_ && seen.generation < oldest->generation))
+        {
+            oldest = &seen;
+        }
+    }
+    *oldest = SeenState{hash_, generation_, epoch_};
+}
+
+std::size_t GameOfLife::mark_active_tiles()
+{
+    std::fill(active_.begin(), active_.end(), 0);
+    for (std::size_t tile_y = 0; tile_y < tiles_y_; ++tile_y)
+    {
+        for (std::size_t tile_x = 0; tile_x < tiles_x_; ++tile_x)
+        {
+            if (!changed_[tile_y * tiles_x_ + tile_x])
+            {
+                continue;
+            }
+
+            for (std::size_t dy = 0; dy < 3; ++dy)
+            {
+                for (std::size_t dx = 0; dx < 3; ++dx)
+                {
+                    // unsigned wrap around, tile - 1 is the last tile
+                    std::size_t x = (tile_x + tiles_x_ + dx - 1) % tiles_x_;
+                    std::size_t y = (tile_y + tiles_y_ + dy - 1) % tiles_y_;
+                    bool wrapped = (x + 1 != tile_x + dx) || (y + 1 != tile_y + dy);
+                    if (wrapped && bounded_)
+                    {
+                        continue;
+                    }
+                    active_[y * tiles_x_ + x] = 1;
+                }
+            }
+        }
+    }
+    std::fill(changed_.begin(), changed_.end(), 0);
+
+    std::size_t active = 0;
+    for (auto tile : active_)
+    {
+        active += tile;
+    }
+    return active;
 }
 
 std::size_t GameOfLife::get_alive_neighbors(const Position &pos)
@@ -152,7 +428,7 @@ std::size_t GameOfLife::get_alive_neighbors(const Position &pos)
         {
             boundary_correction(tmp);
         }
-        if (is_valid_position(tmp) && is_alive(tmp))
+        if (is_valid_position(tmp) && grid_.get(tmp.get_x(), tmp.get_y()))
         {
             ++alive_num;
         }
@@ -0,0 +1,280 @@
+#include "grid_renderer.hpp"
+#include "log.hpp"
+#include "cpp_features.hpp"
+
+#include <cstdlib>
+#include <string>
+
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
+#endif
+#ifndef GL_FRAGMENT_SHADER
+#define GL_FRAGMENT_SHADER 0x8B30
+#define GL_VERTEX_SHADER 0x8B31
+#define GL_COMPILE_STATUS 0x8B81
+#define GL_LINK_STATUS 0x8B82
+#define GL_INFO_LOG_LENGTH 0x8B84
+#endif
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace
+{
+
+// the OpenGL 2.0 functions are not exported everywhere (Windows), they are queried from GLFW
+struct ShaderApi
+{
+    GLuint (APIENTRY *create_shader)(GLenum type);
+    void (APIENTRY *shader_source)(GLuint shader, GLsizei count, const char *const *string,
+                                   const GLint *length);
+    void (APIENTRY *compile_shader)(GLuint shader);
+    void (APIENTRY *get_shader_iv)(GLuint shader, GLenum name, GLint *params);
+    void (APIENTRY *get_shader_info_log)(GLuint shader, GLsizei size, GLsizei *length, char *log);
+    void (APIENTRY *delete_shader)(GLuint shader);
+    GLuint (APIENTRY *create_program)();
+    void (APIENTRY *attach_shader)(GLuint program, GLuint shader);
+    void (APIENTRY *link_program)(GLuint program);
+    void (APIENTRY *get_program_iv)(GLuint program, GLenum name, GLint *params);
+    void (APIENTRY *get_program_info_log)(GLuint program, GLsizei size, GLsizei *length, char *log);
+    void (APIENTRY *use_program)(GLuint program);
+    void (APIENTRY *delete_program)(GLuint program);
+    GLint (APIENTRY *get_uniform_location)(GLuint program, const char *name);
+    void (APIENTRY *uniform_1i)(GLint location, GLint v0);
+    void (APIENTRY *uniform_2f)(GLint location, GLfloat v0, GLfloat v1);
+};
+
+ShaderApi gl = {};
+
+template<class F>
+bool load(F &function, const char *name)
+{
+    function = reinterpret_cast<F>(glfwGetProcAddress(name));
+    return function != nullptr;
+}
+
+bool load_shader_api()
+{
+    return load(gl.create_shader, "glCreateShader") &&
+           load(gl.shader_source, "glShaderSource") &&
+           load(gl.compile_shader, "glCompileShader") &&
+           load(gl.get_shader_iv, "glGetShaderiv") &&
+           load(gl.get_shader_info_log, "glGetShaderInfoLog") &&
+           load(gl.delete_shader, "glDeleteShader") &&
+           load(gl.create_program, "glCreateProgram") &&
+           load(gl.attach_shader, "glAttachShader") &&
+           load(gl.link_program, "glLinkProgram") &&
+           load(gl.get_program_iv, "glGetProgramiv") &&
+           load(gl.get_program_info_log, "glGetProgramInfoLog") &&
+           load(gl.use_program, "glUseProgram") &&
+           load(gl.delete_program, "glDeleteProgram") &&
+           load(gl.get_uniform_location, "glGetUniformLocation") &&
+           load(gl.uniform_1i, "glUniform1i") &&
+           load(gl.uniform_2f, "glUniform2f");
+}
+
+const char *vertex_shader =
+    "#version 110\n"
+    "varying vec2 position;\n"
+    "void main()\n"
+    "{\n"
+    "    position = gl_Vertex.xy;\n"
+    "    gl_Position = ftransform();\n"
+    "}\n";
+
+// the same colors as the old quads and lines: the alive cells cover the grid lines,
+// which are on the top and the left side of every cell
+const char *fragment_shader =
+    "#version 110\n"
+    "uniform sampler2D cells;\n"
+    "uniform vec2 size;\n"
+    "varying vec2 position;\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 cell = position * size;\n"
+    "    float alive = texture2D(cells, (floor(cell) + 0.5) / size).r;\n"
+    "    vec2 line = step(fract(cell), fwidth(cell));\n"
+    "    vec3 background = mix(vec3(1.0), vec3(0.88), max(line.x, line.y));\n"
+    "    gl_FragColor = vec4(mix(background, vec3(0.6, 1.0, 0.6), step(0.5, alive)), 1.0);\n"
+    "}\n";
+
+GLuint compile(GLenum type, const char *source)
+{
+    GLuint shader = gl.create_shader(type);
+    gl.shader_source(shader, 1, &source, nullptr);
+    gl.compile_shader(shader);
+
+    GLint status = GL_FALSE;
+    gl.get_shader_iv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        GLint length = 0;
+        gl.get_shader_iv(shader, GL_INFO_LOG_LENGTH, &length);
+        std::string log(length > 0 ? length : 1, '\0');
+        gl.get_shader_info_log(shader, static_cast<GLsizei>(log.size()), nullptr, &log[0]);
+        Log::warning("shader compilation failed:", log.c_str());
+        gl.delete_shader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+} // anonymous
+
+GridRenderer::GridRenderer() :
+    supported_(false),
+    program_(0),
+    texture_(0),
+    max_texture_size_(0),
+    width_(0),
+    height_(0),
+    version_(0)
+{
+    supported_ = init();
+    if (!supported_)
+    {
+        Log::warning("the shaders are not available, the cells are drawn one by one");
+    }
+}
+
+GridRenderer::~GridRenderer()
+{
+    if (texture_ != 0)
+    {
+        glDeleteTextures(1, &texture_);
+    }
+    if (program_ != 0)
+    {
+        gl.delete_program(program_);
+    }
+}
+
+bool GridRenderer::init()
+{
+    const char *version = reinterpret_cast<const char *>(glGetString(GL_VERSION));
+    if (version == nullptr || std::atoi(version) < 2 || !load_shader_api())
+    {
+        return false;
+    }
+    Log::debug("OpenGL version:", version);
+
+    GLuint vertex = compile(GL_VERTEX_SHADER, vertex_shader);
+    GLuint fragment = compile(GL_FRAGMENT_SHADER, fragment_shader);
+    if (vertex == 0 || fragment == 0)
+    {
+        if (vertex != 0)
+        {
+            gl.delete_shader(vertex);
+        }
+        if (fragment != 0)
+        {
+            gl.delete_shader(fragment);
+        }
+        return false;
+    }
+
+    program_ = gl.create_program();
+    gl.attach_shader(program_, vertex);
+    gl.attach_shader(program_, fragment);
+    gl.link_program(program_);
+    // the program keeps the shaders while it exists
+    gl.delete_shader(vertex);
+    gl.delete_shader(fragment);
+
+    GLint status = GL_FALSE;
+    gl.get_program_iv(program_, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        GLint length = 0;
+        gl.get_program_iv(program_, GL_INFO_LOG_LENGTH, &length);
+        std::string log(length > 0 ? length : 1, '\0');
+        gl.get_program_info_log(program_, static_cast<GLsizei>(log.size()), nullptr, &log[0]);
+        Log::warning("shader linking failed:", log.c_str());
+        gl.delete_program(program_);
+        program_ = 0;
+        return false;
+    }
+
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size_);
+    glGenTextures(1, &texture_);
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+bool GridRenderer::draw(const BitGrid &grid, std::size_t version)
+{
+    std::size_t width = grid.get_width();
+    std::size_t height = grid.get_height();
+    if (!supported_ || width > static_cast<std::size_t>(max_texture_size_) ||
+            height > static_cast<std::size_t>(max_texture_size_))
+    {
+        return false;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    if (width != width_ || height != height_ || version != version_)
+    {
+        upload(grid);
+        version_ = version;
+    }
+
+    gl.use_program(program_);
+    gl.uniform_1i(gl.get_uniform_location(program_, "cells"), 0);
+    gl.uniform_2f(gl.get_uniform_location(program_, "size"),
+                  static_cast<GLfloat>(width), static_cast<GLfloat>(height));
+
+    glBegin(GL_QUADS);
+    glVertex2f(0.f, 0.f);
+    glVertex2f(1.f, 0.f);
+    glVertex2f(1.f, 1.f);
+    glVertex2f(0.f, 1.f);
+    glEnd();
+
+    gl.use_program(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+void GridRenderer::upload(const BitGrid &grid)
+{
+    std::size_t width = grid.get_width();
+    std::size_t height = grid.get_height();
+    texels_.resize(width * height);
+
+    // one byte per cell, a row at a time
+    std::uint8_t *texel = texels_.data();
+    for (std::size_t y = 0; y < height; ++y)
+    {
+        const BitGrid::word_type *row = grid.row(y);
+        for (std::size_t x = 0; x < width; ++x)
+        {
+            *texel++ = ((row[x / BitGrid::word_bits] >> (x % BitGrid::word_bits)) & 1) ? 255 : 0;
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (width != width_ || height != height_)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, static_cast<GLsizei>(width),
+                     static_cast<GLsizei>(height), 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, texels_.data());
+        width_ = width;
+        height_ = height;
+    }
+    else
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, static_cast<GLsizei>(width),
+                        static_cast<GLsizei>(height), GL_LUMINANCE, GL_UNSIGNED_BYTE, texels_.data());
+    }
+}
+
+} // gol
+
+} // nzs
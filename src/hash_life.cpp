@@ -0,0 +1,863 @@
+#include "hash_life.hpp"
+#include "log.hpp"
+#include "cpp_features.hpp"
+
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+const HashLife::node_id HashLife::none;
+const HashLife::node_id HashLife::dead;
+const HashLife::node_id HashLife::alive;
+
+namespace
+{
+
+// the smallest root, 8x8 cells
+const unsigned min_level = 3;
+
+// the root must stay addressable with 64-bit coordinates
+const unsigned max_level = 62;
+
+} // anonymous
+
+HashLife::HashLife(std::size_t max_nodes) :
+    max_nodes_(max_nodes),
+    live_nodes_(0),
+    free_list_(none),
+    root_(none),
+    generation_(0),
+    stepping_(false)
+{
+    clear();
+}
+
+bool HashLife::supports(const Rule &rule) NOEXCEPT
+{
+    // successor_level_2() calculates Conway's Life
+    return rule == Rule();
+}
+
+void HashLife::kill(const Position &pos)
+{
+    if (is_alive(pos))
+    {
+        set_cell(pos, false);
+    }
+}
+
+void HashLife::born(const Position &pos)
+{
+    if (!is_alive(pos))
+    {
+        set_cell(pos, true);
+    }
+}
+
+void HashLife::flip(const Position &pos)
+{
+    set_cell(pos, !is_alive(pos));
+}
+
+void HashLife::next(std::uint64_t iteration)
+{
+    for (unsigned power = 0; iteration != 0; ++power, iteration >>= 1)
+    {
+        if (iteration & 1)
+        {
+            jump(power);
+        }
+    }
+}
+
+void HashLife::jump(unsigned power)
+{
+    if (power + min_level > max_level)
+    {
+        throw std::out_of_range("HashLife::jump");
+    }
+
+    if (live_nodes_ > max_nodes_ / 2)
+    {
+        collect_garbage();
+    }
+
+    try
+    {
+        advance(power);
+    }
+    catch (const std::length_error &)
+    {
+        // a failed jump does not change the root: free the nodes of the attempt
+        // and take the same generations in two halves, they need fewer nodes
+        collect_garbage();
+        Log::verbose("hashlife cache full, jump split:", power);
+        if (power == 0)
+        {
+            advance(0);
+            return;
+        }
+        jump(power - 1);
+        jump(power - 1);
+    }
+}
+
+void HashLife::advance(unsigned power)
+{
+    stepping_ = true;
+    try
+    {
+        // the result is the centre half of the root, so the pattern needs
+        // a 2^power cells wide empty border inside it
+        while (true)
+        {
+            const Node &root = nodes_[root_];
+            if (root.level >= power + min_level)
+            {
+                const Node &nw = nodes_[nodes_[root.nw].se];
+                const Node &ne = nodes_[nodes_[root.ne].sw];
+                const Node &sw = nodes_[nodes_[root.sw].ne];
+                const Node &se = nodes_[nodes_[root.se].nw];
+                std::uint64_t inner = nodes_[nw.se].population + nodes_[ne.sw].population +
+                                      nodes_[sw.ne].population + nodes_[se.nw].population;
+                if (inner == root.population)
+                {
+                    break;
+                }
+            }
+            expand();
+        }
+
+        root_ = successor(root_, power);
+    }
+    catch (const std::length_error &)
+    {
+        stepping_ = false;
+        throw;
+    }
+    stepping_ = false;
+    generation_ += std::uint64_t(1) << power;
+}
+
+void HashLife::clear()
+{
+    nodes_.clear();
+    buckets_.clear();
+    empty_.clear();
+    free_list_ = none;
+    generation_ = 0;
+
+    // the two leaves
+    Node leaf = {none, none, none, none, none, none, 0, 0, 0};
+    nodes_.push_back(leaf);
+    leaf.population = 1;
+    nodes_.push_back(leaf);
+    live_nodes_ = 2;
+    empty_.push_back(dead);
+
+    rehash(1 << 10);
+    root_ = empty(min_level);
+}
+
+bool HashLife::is_alive(const Position &pos) const
+{
+    if (!contains(pos))
+    {
+        return false;
+    }
+
+    node_id node = root_;
+    std::int64_t half = std::int64_t(1) << (nodes_[root_].level - 1);
+    std::int64_t x = pos.get_x() + half;
+    std::int64_t y = pos.get_y() + half;
+    while (nodes_[node].level > 0)
+    {
+        const Node &n = nodes_[node];
+        half = std::int64_t(1) << (n.level - 1);
+        bool east = x >= half;
+        bool south = y >= half;
+        node = south ? (east ? n.se : n.sw) : (east ? n.ne : n.nw);
+        x -= east ? half : 0;
+        y -= south ? half : 0;
+    }
+    return node == alive;
+}
+
+std::uint64_t HashLife::population() const NOEXCEPT
+{
+    return nodes_[root_].population;
+}
+
+void HashLife::collect_garbage()
+{
+    std::vector<char> marked(nodes_.size(), 0);
+    marked[dead] = marked[alive] = 1;
+
+    std::vector<node_id> stack(empty_.begin(), empty_.end());
+    stack.push_back(root_);
+    while (!stack.empty())
+    {
+        node_id node = stack.back();
+        stack.pop_back();
+        if (marked[node])
+        {
+            continue;
+        }
+        marked[node] = 1;
+
+        const Node &n = nodes_[node];
+        stack.push_back(n.nw);
+        stack.push_back(n.ne);
+        stack.push_back(n.sw);
+        stack.push_back(n.se);
+    }
+
+    // free the unreachable nodes, forget the results which point to them
+    free_list_ = none;
+    live_nodes_ = 0;
+    for (std::size_t i = nodes_.size(); i-- > 0;)
+    {
+        Node &n = nodes_[i];
+        if (marked[i])
+        {
+            ++live_nodes_;
+            if (n.result != none && !marked[n.result])
+            {
+                n.result = none;
+            }
+        }
+        else
+        {
+            n.level = 0;
+            n.result = none;
+            n.next = free_list_;
+            free_list_ = static_cast<node_id>(i);
+        }
+    }
+
+    rehash(buckets_.size());
+    NZS_LOG_VERBOSE("hashlife gc, nodes:", live_nodes_);
+}
+
+void HashLife::set_cells(const BitGrid &grid, const Position64 &offset)
+{
+    clear();
+
+    // the smallest root which contains the grid
+    std::int64_t right = offset.get_x() + static_cast<std::int64_t>(grid.get_width());
+    std::int64_t bottom = offset.get_y() + static_cast<std::int64_t>(grid.get_height());
+    unsigned level = min_level;
+    while (true)
+    {
+        std::int64_t half = std::int64_t(1) << (level - 1);
+        if (offset.get_x() >= -half && offset.get_y() >= -half && right <= half && bottom <= half)
+        {
+            break;
+        }
+        if (++level > max_level)
+        {
+            throw std::out_of_range("HashLife::set_cells");
+        }
+    }
+
+    std::int64_t half = std::int64_t(1) << (level - 1);
+    root_ = build(grid, level, -half - offset.get_x(), -half - offset.get_y());
+}
+
+void HashLife::get_cells(std::vector<Position64> &cells) const
+{
+    std::int64_t half = std::int64_t(1) << (nodes_[root_].level - 1);
+    get_cells(root_, -half, -half, cells);
+}
+
+bool HashLife::read_macrocell(std::istream &in, std::string &rule)
+{
+    clear();
+
+    // the nodes in the order of their lines, 0 means an empty node
+    std::vector<node_id> ids(1, none);
+    std::uint64_t generation = 0;
+    std::size_t line_number = 0;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        ++line_number;
+        if (!line.empty() && line[line.size() - 1] == '\r')
+        {
+            line.erase(line.size() - 1);
+        }
+        if (line.empty() || line[0] == '[')
+        {
+            continue;
+        }
+
+        bool broken = false;
+        if (line[0] == '#')
+        {
+            std::size_t first = line.find_first_not_of(' ', 2);
+            std::string value = first == std::string::npos ? std::string() : line.substr(first);
+            if (line.compare(0, 2, "#R") == 0)
+            {
+                rule = value;
+            }
+            else if (line.compare(0, 2, "#G") == 0)
+            {
+                generation = std::strtoull(value.c_str(), nullptr, 10);
+            }
+            continue;
+        }
+        else if (line[0] == '.' || line[0] == '*' || line[0] == '$')
+        {
+            // 8x8 cells, '$' ends a row
+            std::uint64_t cells = 0;
+            unsigned x = 0;
+            unsigned y = 0;
+            for (char c : line)
+            {
+                if (c == '$')
+                {
+                    x = 0;
+                    ++y;
+                }
+                else if ((c == '.' || c == '*') && x < 8 && y < 8)
+                {
+                    cells |= std::uint64_t(c == '*') << (y * 8 + x);
+                    ++x;
+                }
+                else
+                {
+                    broken = true;
+                    break;
+                }
+            }
+            ids.push_back(leaf(cells));
+        }
+        else
+        {
+            // "level nw ne sw se", the children of level 1 nodes are cells
+            std::uint64_t values[5];
+            const char *text = line.c_str();
+            for (auto &value : values)
+            {
+                char *end;
+                value = std::strtoull(text, &end, 10);
+                broken = broken || end == text;
+                text = end;
+            }
+            unsigned level = static_cast<unsigned>(values[0]);
+            broken = broken || level == 0 || level > max_level;
+
+            node_id quads[4] = {};
+            for (unsigned i = 0; i < 4 && !broken; ++i)
+            {
+                std::uint64_t child = values[i + 1];
+                if (level == 1)
+                {
+                    broken = child > 1;
+                    quads[i] = child == 1 ? alive : dead;
+                }
+                else if (child == 0)
+                {
+                    quads[i] = empty(level - 1);
+                }
+                else if (child < ids.size() && nodes_[ids[child]].level == level - 1)
+                {
+                    quads[i] = ids[child];
+                }
+                else
+                {
+                    broken = true;
+                }
+            }
+            if (!broken)
+            {
+                ids.push_back(join(quads[0], quads[1], quads[2], quads[3]));
+            }
+        }
+
+        if (broken)
+        {
+            Log::error("bad macrocell node in line", line_number, ":", line);
+            clear();
+            return false;
+        }
+    }
+
+    // the last node is the root
+    if (ids.size() > 1)
+    {
+        root_ = ids.back();
+    }
+    while (nodes_[root_].level < min_level)
+    {
+        expand();
+    }
+    generation_ = generation;
+    return true;
+}
+
+void HashLife::write_macrocell(std::ostream &out, const std::string &rule) const
+{
+    out << "[M2] (nzs game_of_life)\n";
+    out << "#R " << rule << "\n";
+    if (generation_ != 0)
+    {
+        out << "#G " << generation_ << "\n";
+    }
+
+    // the nodes are numbered from 1 in the order of their lines, the children are
+    // written before their parents and the empty nodes are 0
+    std::vector<std::uint32_t> index(nodes_.size(), 0);
+    std::uint32_t count = 0;
+    auto index_of = [&](node_id node)
+    {
+        return nodes_[node].population == 0 ? 0 : index[node];
+    };
+
+    if (nodes_[root_].population == 0)
+    {
+        out << "$\n";
+        return;
+    }
+
+    // node and its children are written
+    std::vector<std::pair<node_id, bool> > stack(1, std::make_pair(root_, false));
+    std::string line;
+    while (!stack.empty())
+    {
+        node_id node = stack.back().first;
+        bool children_written = stack.back().second;
+        stack.pop_back();
+        if (index[node] != 0 || nodes_[node].population == 0)
+        {
+            continue;
+        }
+
+        const Node &n = nodes_[node];
+        if (n.level > min_level && !children_written)
+        {
+            stack.push_back(std::make_pair(node, true));
+            stack.push_back(std::make_pair(n.se, false));
+            stack.push_back(std::make_pair(n.sw, false));
+            stack.push_back(std::make_pair(n.ne, false));
+            stack.push_back(std::make_pair(n.nw, false));
+            continue;
+        }
+
+        if (n.level == min_level)
+        {
+            // the dead cells at the end of the rows and the empty rows at the end are left out
+            std::uint64_t cells = leaf_cells(node);
+            line.clear();
+            for (unsigned y = 0; y < 8 && (cells >> (y * 8)) != 0; ++y)
+            {
+                unsigned row = (cells >> (y * 8)) & 0xff;
+                for (; row != 0; row >>= 1)
+                {
+                    line += (row & 1) ? '*' : '.';
+                }
+                line += '$';
+            }
+            out << line << "\n";
+        }
+        else
+        {
+            out << static_cast<unsigned>(n.level) << ' ' << index_of(n.nw) << ' '
+                << index_of(n.ne) << ' ' << index_of(n.sw) << ' ' << index_of(n.se) << "\n";
+        }
+        index[node] = ++count;
+    }
+}
+
+HashLife::node_id HashLife::join(node_id nw, node_id ne, node_id sw, node_id se)
+{
+    std::size_t bucket = bucket_of(nw, ne, sw, se);
+    for (node_id i = buckets_[bucket]; i != none; i = nodes_[i].next)
+    {
+        const Node &n = nodes_[i];
+        if (n.nw == nw && n.ne == ne && n.sw == sw && n.se == se)
+        {
+            return i;
+        }
+    }
+
+    if (stepping_ && live_nodes_ >= max_nodes_)
+    {
+        throw std::length_error("HashLife: the node cache is full");
+    }
+
+    Node node = {nw, ne, sw, se, buckets_[bucket], none,
+                 nodes_[nw].population + nodes_[ne].population +
+                 nodes_[sw].population + nodes_[se].population,
+                 static_cast<std::uint8_t>(nodes_[nw].level + 1), 0
+                };
+
+    node_id id;
+    if (free_list_ != none)
+    {
+        id = free_list_;
+        free_list_ = nodes_[id].next;
+        nodes_[id] = node;
+    }
+    else
+    {
+        id = static_cast<node_id>(nodes_.size());
+        nodes_.push_back(node);
+    }
+    buckets_[bucket] = id;
+    ++live_nodes_;
+
+    if (live_nodes_ > buckets_.size())
+    {
+        rehash(buckets_.size() * 2);
+    }
+    return id;
+}
+
+HashLife::node_id HashLife::empty(unsigned level)
+{
+    while (empty_.size() <= level)
+    {
+        node_id e = empty_.back();
+        empty_.push_back(join(e, e, e, e));
+    }
+    return empty_[level];
+}
+
+HashLife::node_id HashLife::centre(node_id node)
+{
+    const Node &n = nodes_[node];
+    node_id nw = nodes_[n.nw].se;
+    node_id ne = nodes_[n.ne].sw;
+    node_id sw = nodes_[n.sw].ne;
+    node_id se = nodes_[n.se].nw;
+    return join(nw, ne, sw, se);
+}
+
+HashLife::node_id HashLife::successor(node_id node, unsigned step)
+{
+    const Node &n = nodes_[node];
+    unsigned level = n.level;
+    if (n.population == 0)
+    {
+        return empty(level - 1);
+    }
+    if (n.result != none && n.result_step == step)
+    {
+        return n.result;
+    }
+
+    node_id result;
+    if (level == 2)
+    {
+        result = successor_level_2(node);
+    }
+    else
+    {
+        // copies, join() may reallocate the node vector
+        node_id nw = n.nw;
+        node_id ne = n.ne;
+        node_id sw = n.sw;
+        node_id se = n.se;
+        const Node a = nodes_[nw];
+        const Node b = nodes_[ne];
+        const Node c = nodes_[sw];
+        const Node d = nodes_[se];
+
+        // the nine overlapping subnodes of level - 1
+        node_id sub[9] =
+        {
+            nw,
+            join(a.ne, b.nw, a.se, b.sw),
+            ne,
+            join(a.sw, a.se, c.nw, c.ne),
+            join(a.se, b.sw, c.ne, d.nw),
+            join(b.sw, b.se, d.nw, d.ne),
+            sw,
+            join(c.ne, d.nw, c.se, d.sw),
+            se
+        };
+
+        // full speed steps twice, slower steps only once
+        bool full_speed = (step == level - 2);
+        for (auto &s : sub)
+        {
+            s = full_speed ? successor(s, step - 1) : centre(s);
+        }
+
+        unsigned quad_step = full_speed ? step - 1 : step;
+        node_id r_nw = successor(join(sub[0], sub[1], sub[3], sub[4]), quad_step);
+        node_id r_ne = successor(join(sub[1], sub[2], sub[4], sub[5]), quad_step);
+        node_id r_sw = successor(join(sub[3], sub[4], sub[6], sub[7]), quad_step);
+        node_id r_se = successor(join(sub[4], sub[5], sub[7], sub[8]), quad_step);
+        result = join(r_nw, r_ne, r_sw, r_se);
+    }
+
+    // the node vector may have been reallocated
+    nodes_[node].result = result;
+    nodes_[node].result_step = static_cast<std::uint8_t>(step);
+    return result;
+}
+
+HashLife::node_id HashLife::successor_level_2(node_id node)
+{
+    // read the 4x4 cells, bit y * 4 + x
+    unsigned cells = 0;
+    const Node &n = nodes_[node];
+    node_id quads[4] = {n.nw, n.ne, n.sw, n.se};
+    for (unsigned q = 0; q < 4; ++q)
+    {
+        const Node &quad = nodes_[quads[q]];
+        unsigned x = (q % 2) * 2;
+        unsigned y = (q / 2) * 2;
+        cells |= (quad.nw == alive) << (y * 4 + x);
+        cells |= (quad.ne == alive) << (y * 4 + x + 1);
+        cells |= (quad.sw == alive) << ((y + 1) * 4 + x);
+        cells |= (quad.se == alive) << ((y + 1) * 4 + x + 1);
+    }
+
+    node_id next[4];
+    for (unsigned q = 0; q < 4; ++q)
+    {
+        unsigned x = 1 + q % 2;
+        unsigned y = 1 + q / 2;
+        unsigned neighbors = 0;
+        for (unsigned dy = 0; dy < 3; ++dy)
+        {
+            for (unsigned dx = 0; dx < 3; ++dx)
+            {
+                if (dx != 1 || dy != 1)
+                {
+                    neighbors += (cells >> ((y + dy - 1) * 4 + x + dx - 1)) & 1;
+                }
+            }
+        }
+        bool is_alive = (cells >> (y * 4 + x)) & 1;
+        next[q] = (neighbors == 3 || (is_alive && neighbors == 2)) ? alive : dead;
+    }
+
+    return join(next[0], next[1], next[2], next[3]);
+}
+
+HashLife::node_id HashLife::leaf(std::uint64_t cells)
+{
+    if (cells == 0)
+    {
+        return empty(min_level);
+    }
+
+    auto cell = [cells](unsigned x, unsigned y)
+    {
+        return ((cells >> (y * 8 + x)) & 1) ? alive : dead;
+    };
+
+    node_id quads[4];
+    for (unsigned q = 0; q < 4; ++q)
+    {
+        node_id pairs[4];
+        for (unsigned p = 0; p < 4; ++p)
+        {
+            unsigned x = (q % 2) * 4 + (p % 2) * 2;
+            unsigned y = (q / 2) * 4 + (p / 2) * 2;
+            pairs[p] = join(cell(x, y), cell(x + 1, y), cell(x, y + 1), cell(x + 1, y + 1));
+        }
+        quads[q] = join(pairs[0], pairs[1], pairs[2], pairs[3]);
+    }
+    return join(quads[0], quads[1], quads[2], quads[3]);
+}
+
+std::uint64_t HashLife::leaf_cells(node_id node) const
+{
+    std::uint64_t cells = 0;
+    for (unsigned y = 0; y < 8; ++y)
+    {
+        for (unsigned x = 0; x < 8; ++x)
+        {
+            node_id cell = node;
+            for (unsigned half = 4; half > 0; half /= 2)
+            {
+                const Node &n = nodes_[cell];
+                bool east = (x & half) != 0;
+                bool south = (y & half) != 0;
+                cell = south ? (east ? n.se : n.sw) : (east ? n.ne : n.nw);
+            }
+            cells |= std::uint64_t(cell == alive) << (y * 8 + x);
+        }
+    }
+    return cells;
+}
+
+HashLife::node_id HashLife::build(const BitGrid &grid, unsigned level, std::int64_t x, std::int64_t y)
+{
+    // x and y are the grid coordinates of the top left corner of the node
+    std::int64_t width = static_cast<std::int64_t>(grid.get_width());
+    std::int64_t height = static_cast<std::int64_t>(grid.get_height());
+    std::int64_t size = std::int64_t(1) << level;
+    if (x >= width || y >= height || x + size <= 0 || y + size <= 0)
+    {
+        return empty(level);
+    }
+
+    if (level == min_level)
+    {
+        std::uint64_t cells = 0;
+        for (std::int64_t dy = 0; dy < 8; ++dy)
+        {
+            for (std::int64_t dx = 0; dx < 8; ++dx)
+            {
+                std::int64_t cx = x + dx;
+                std::int64_t cy = y + dy;
+                if (cx >= 0 && cy >= 0 && cx < width && cy < height &&
+                        grid.get(static_cast<std::size_t>(cx), static_cast<std::size_t>(cy)))
+                {
+                    cells |= std::uint64_t(1) << (dy * 8 + dx);
+                }
+            }
+        }
+        return leaf(cells);
+    }
+
+    std::int64_t half = size / 2;
+    node_id nw = build(grid, level - 1, x, y);
+    node_id ne = build(grid, level - 1, x + half, y);
+    node_id sw = build(grid, level - 1, x, y + half);
+    node_id se = build(grid, level - 1, x + half, y + half);
+    return join(nw, ne, sw, se);
+}
+
+void HashLife::get_cells(node_id node, std::int64_t x, std::int64_t y,
+                         std::vector<Position64> &cells) const
+{
+    const Node &n = nodes_[node];
+    if (n.population == 0)
+    {
+        return;
+    }
+    if (n.level == 0)
+    {
+        cells.push_back({x, y});
+        return;
+    }
+
+    std::int64_t half = std::int64_t(1) << (n.level - 1);
+    get_cells(n.nw, x, y, cells);
+    get_cells(n.ne, x + half, y, cells);
+    get_cells(n.sw, x, y + half, cells);
+    get_cells(n.se, x + half, y + half, cells);
+}
+
+void HashLife::expand()
+{
+    const Node &root = nodes_[root_];
+    if (root.level >= max_level)
+    {
+        throw std::out_of_range("HashLife::expand");
+    }
+
+    node_id nw = root.nw;
+    node_id ne = root.ne;
+    node_id sw = root.sw;
+    node_id se = root.se;
+    node_id e = empty(root.level - 1);
+
+    node_id new_nw = join(e, e, e, nw);
+    node_id new_ne = join(e, e, ne, e);
+    node_id new_sw = join(e, sw, e, e);
+    node_id new_se = join(se, e, e, e);
+    root_ = join(new_nw, new_ne, new_sw, new_se);
+}
+
+bool HashLife::contains(const Position &pos) const NOEXCEPT
+{
+    std::int64_t half = std::int64_t(1) << (nodes_[root_].level - 1);
+    return pos.get_x() >= -half && pos.get_x() < half &&
+           pos.get_y() >= -half && pos.get_y() < half;
+}
+
+void HashLife::set_cell(const Position &pos, bool alive)
+{
+    while (!contains(pos))
+    {
+        expand();
+    }
+
+    std::int64_t half = std::int64_t(1) << (nodes_[root_].level - 1);
+    root_ = set_cell(root_, pos.get_x() + half, pos.get_y() + half, alive);
+}
+
+HashLife::node_id HashLife::set_cell(node_id node, std::int64_t x, std::int64_t y, bool alive)
+{
+    const Node &n = nodes_[node];
+    if (n.level == 0)
+    {
+        return alive ? HashLife::alive : dead;
+    }
+
+    std::int64_t half = std::int64_t(1) << (n.level - 1);
+    node_id nw = n.nw;
+    node_id ne = n.ne;
+    node_id sw = n.sw;
+    node_id se = n.se;
+    if (y < half)
+    {
+        if (x < half)
+        {
+            nw = set_cell(nw, x, y, alive);
+        }
+        else
+        {
+            ne = set_cell(ne, x - half, y, alive);
+        }
+    }
+    else
+    {
+        if (x < half)
+        {
+            sw = set_cell(sw, x, y - half, alive);
+        }
+        else
+        {
+            se = set_cell(se, x - half, y - half, alive);
+        }
+    }
+    return join(nw, ne, sw, se);
+}
+
+void HashLife::rehash(std::size_t bucket_count)
+{
+    buckets_.assign(bucket_count, none);
+    for (std::size_t i = alive + 1; i < nodes_.size(); ++i)
+    {
+        Node &n = nodes_[i];
+        if (n.level == 0)
+        {
+            // free slot
+            continue;
+        }
+        std::size_t bucket = bucket_of(n.nw, n.ne, n.sw, n.se);
+        n.next = buckets_[bucket];
+        buckets_[bucket] = static_cast<node_id>(i);
+    }
+}
+
+std::size_t HashLife::bucket_of(node_id nw, node_id ne, node_id sw, node_id se) const NOEXCEPT
+{
+    std::uint64_t hash = nw;
+    hash = hash * 0x9E3779B97F4A7C15ull + ne;
+    hash = hash * 0x9E3779B97F4A7C15ull + sw;
+    hash = hash * 0x9E3779B97F4A7C15ull + se;
+    hash ^= hash >> 29;
+    return static_cast<std::size_t>(hash & (buckets_.size() - 1));
+}
+
+} // gol
+
+} // nzs
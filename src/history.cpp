@@ -0,0 +1,203 @@
+#include "history.hpp"
+#include "log.hpp"
+#include "cpp_features.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace
+{
+
+inline std::size_t entry_bytes(std::size_t words) NOEXCEPT
+{
+    return words * (sizeof(std::uint32_t) + sizeof(BitGrid::word_type)) + 64;
+}
+
+} // anonymous
+
+History::History(std::size_t max_bytes, std::size_t keyframe_interval) :
+    max_bytes_(max_bytes),
+    keyframe_interval_(keyframe_interval == 0 ? 1 : keyframe_interval),
+    bytes_(0),
+    since_keyframe_(0),
+    recorded_(false),
+    current_(0, 0),
+    generation_(0),
+    version_(0)
+{
+}
+
+void History::push(const GameOfLife &game)
+{
+    if (recorded_ && game.version() == version_)
+    {
+        return;
+    }
+
+    const BitGrid &grid = game.grid();
+    std::size_t count = grid.words_per_row() * grid.get_height();
+    if (count > std::numeric_limits<std::uint32_t>::max())
+    {
+        // the positions do not fit, there is no history of such a large grid
+        clear();
+        return;
+    }
+
+    if (recorded_)
+    {
+        Entry entry = {generation_, current_.get_width(), current_.get_height(), false, {}, {}};
+        BitGrid::word_type *old_words = current_.row(0);
+        const BitGrid::word_type *new_words = grid.row(0);
+        bool same_size = current_.get_width() == grid.get_width() &&
+                         current_.get_height() == grid.get_height();
+        entry.keyframe = !same_size || since_keyframe_ + 1 >= keyframe_interval_;
+
+        if (entry.keyframe)
+        {
+            std::size_t old_count = current_.words_per_row() * current_.get_height();
+            for (std::size_t i = 0; i < old_count; ++i)
+            {
+                if (old_words[i] != 0)
+                {
+                    entry.positions.push_back(static_cast<std::uint32_t>(i));
+                    entry.words.push_back(old_words[i]);
+                }
+            }
+        }
+        else
+        {
+            // only the tiles which changed since the last recorded state are compared,
+            // so a push costs as much as the step and not the whole grid
+            std::size_t words_per_row = grid.words_per_row();
+            game.changed_tiles(version_, [&](std::size_t first_row, std::size_t last_row,
+                                             std::size_t first_word, std::size_t last_word)
+            {
+                for (std::size_t y = first_row; y < last_row; ++y)
+                {
+                    std::size_t row = y * words_per_row;
+                    for (std::size_t i = row + first_word; i < row + last_word; ++i)
+                    {
+                        BitGrid::word_type delta = old_words[i] ^ new_words[i];
+                        if (delta != 0)
+                        {
+                            entry.positions.push_back(static_cast<std::uint32_t>(i));
+                            entry.words.push_back(delta);
+                            // only the changed words of the copy are updated
+                            old_words[i] = new_words[i];
+                        }
+                    }
+                }
+            });
+        }
+
+        if (entry.keyframe)
+        {
+            current_ = grid;
+        }
+        add(std::move(entry));
+    }
+    else
+    {
+        current_ = grid;
+        recorded_ = true;
+    }
+    generation_ = game.generation();
+    version_ = game.version();
+}
+
+bool History::rewind(std::size_t steps, GameOfLife &game)
+{
+    steps = std::min(steps, entries_.size());
+    if (steps == 0)
+    {
+        return false;
+    }
+    std::size_t target = entries_.size() - steps;
+
+    // start from the nearest keyframe above the target or from the last state,
+    // then go down by the deltas
+    std::size_t first = entries_.size();
+    for (std::size_t i = target; i < entries_.size(); ++i)
+    {
+        if (entries_[i].keyframe)
+        {
+            first = i;
+            break;
+        }
+    }
+
+    BitGrid state(0, 0);
+    if (first == entries_.size())
+    {
+        state.swap(current_);
+    }
+    else
+    {
+        const Entry &keyframe = entries_[first];
+        state = BitGrid(keyframe.width, keyframe.height);
+        BitGrid::word_type *words = state.row(0);
+        for (std::size_t i = 0; i < keyframe.positions.size(); ++i)
+        {
+            words[keyframe.positions[i]] = keyframe.words[i];
+        }
+    }
+
+    for (std::size_t i = first; i-- > target;)
+    {
+        const Entry &entry = entries_[i];
+        BitGrid::word_type *words = state.row(0);
+        for (std::size_t j = 0; j < entry.positions.size(); ++j)
+        {
+            words[entry.positions[j]] ^= entry.words[j];
+        }
+    }
+
+    std::size_t generation = entries_[target].generation;
+    while (entries_.size() > target)
+    {
+        bytes_ -= entry_bytes(entries_.back().positions.size());
+        entries_.pop_back();
+    }
+    since_keyframe_ = 0;
+
+    current_ = state;
+    game.restore(std::move(state), generation);
+    generation_ = game.generation();
+    version_ = game.version();
+    NZS_LOG_VERBOSE("rewind to generation:", generation, "history:", entries_.size());
+    return true;
+}
+
+void History::clear()
+{
+    entries_.clear();
+    bytes_ = 0;
+    since_keyframe_ = 0;
+    recorded_ = false;
+    current_ = BitGrid(0, 0);
+}
+
+void History::add(Entry entry)
+{
+    since_keyframe_ = entry.keyframe ? 0 : since_keyframe_ + 1;
+    bytes_ += entry_bytes(entry.positions.size());
+    entries_.push_back(std::move(entry));
+
+    // the oldest states go first, a delta is still valid without them
+    while (bytes_ > max_bytes_ && !entries_.empty())
+    {
+        bytes_ -= entry_bytes(entries_.front().positions.size());
+        entries_.pop_front();
+    }
+}
+
+} // gol
+
+} // nzs
@@ -0,0 +1,342 @@
+#include "life_kernel.hpp"
+#include "life_logic.hpp"
+#include "cpp_features.hpp"
+
+#if defined(NZS_X86_SIMD) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace details
+{
+
+namespace
+{
+
+const std::size_t last_bit = BitGrid::word_bits - 1;
+
+Simd detect_simd() NOEXCEPT
+{
+#if defined(NZS_X86_SIMD) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return Simd::avx2;
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return Simd::sse2;
+    }
+#elif defined(NZS_X86_SIMD) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 &&
+                        (_xgetbv(0) & 6) == 6;
+    if (max_leaf >= 7 && os_saves_ymm)
+    {
+        __cpuidex(info, 7, 0);
+        if (info[1] & (1 << 5))
+        {
+            return Simd::avx2;
+        }
+    }
+    if (sse2)
+    {
+        return Simd::sse2;
+    }
+#endif
+    return Simd::scalar;
+}
+
+span_function span_for(Simd simd, const Rule &rule) NOEXCEPT
+{
+    switch (simd)
+    {
+    case Simd::avx2:
+        return span_avx2(rule);
+    case Simd::sse2:
+        return span_sse2(rule);
+    default:
+        return nullptr;
+    }
+}
+
+const Simd supported_simd = detect_simd();
+Simd active_simd = supported_simd;
+
+// next state of one word of cells of any rule through its lookup table
+struct TableCells
+{
+    const std::uint8_t *table;
+
+    // 3x3 neighborhood of bit i, the rows are in the bits 0..2, 3..5 and 6..8
+    static inline std::size_t neighborhood(word_type up_w, word_type up, word_type up_e,
+                                           word_type w, word_type mid, word_type e,
+                                           word_type down_w, word_type down, word_type down_e,
+                                           std::size_t i) NOEXCEPT
+    {
+        return ((up_w >> i) & 1) | ((up >> i) & 1) << 1 | ((up_e >> i) & 1) << 2 |
+               ((w >> i) & 1) << 3 | ((mid >> i) & 1) << 4 | ((e >> i) & 1) << 5 |
+               ((down_w >> i) & 1) << 6 | ((down >> i) & 1) << 7 | ((down_e >> i) & 1) << 8;
+    }
+
+    inline word_type operator()(word_type up_w, word_type up, word_type up_e,
+                                word_type w, word_type mid, word_type e,
+                                word_type down_w, word_type down, word_type down_e) const
+    {
+        // nothing is born in an empty neighborhood (unless the rule has B0)
+        if ((up | mid | down | up_w | w | down_w | up_e | e | down_e) == 0)
+        {
+            return table[0] ? ~word_type(0) : 0;
+        }
+
+        // the neighborhood of the bits which are not at a word or a grid edge can be
+        // read from the unshifted rows, the rest is collected bit by bit
+        const word_type inner = ~word_type(0) >> 1;
+        word_type east_edges = (up_e ^ (up >> 1)) | (e ^ (mid >> 1)) | (down_e ^ (down >> 1));
+        word_type west_edges = (up_w ^ (up << 1)) | (w ^ (mid << 1)) | (down_w ^ (down << 1));
+        word_type edges = ~inner | 1 | (east_edges & inner) | (west_edges & ~word_type(1));
+
+        word_type next = 0;
+        for (std::size_t i = 0; i < BitGrid::word_bits; ++i)
+        {
+            std::size_t index = 0;
+            if ((edges >> i) & 1)
+            {
+                index = neighborhood(up_w, up, up_e, w, mid, e, down_w, down, down_e, i);
+            }
+            else
+            {
+                index = ((up >> (i - 1)) & 7) | ((mid >> (i - 1)) & 7) << 3 |
+                        ((down >> (i - 1)) & 7) << 6;
+            }
+            next |= word_type(table[index]) << i;
+        }
+        return next;
+    }
+};
+
+template<class Cells>
+std::size_t life_span_scalar(const Cells &cells, const word_type *up, const word_type *mid,
+                             const word_type *down, word_type *out,
+                             std::size_t first, std::size_t last,
+                             word_type &changed, std::size_t &population) NOEXCEPT
+{
+    for (std::size_t i = first; i < last; ++i)
+    {
+        out[i] = cells((up[i] << 1) | (up[i - 1] >> last_bit), up[i],
+                       (up[i] >> 1) | (up[i + 1] << last_bit),
+                       (mid[i] << 1) | (mid[i - 1] >> last_bit), mid[i],
+                       (mid[i] >> 1) | (mid[i + 1] << last_bit),
+                       (down[i] << 1) | (down[i - 1] >> last_bit), down[i],
+                       (down[i] >> 1) | (down[i + 1] << last_bit));
+        changed |= out[i] ^ mid[i];
+        population += popcount(out[i]);
+    }
+    return last;
+}
+
+// cells shifted by one to the east, so every bit holds its west neighbor
+inline word_type west_of(const word_type *row, std::size_t i, word_type carry) NOEXCEPT
+{
+    return (row[i] << 1) | (i > 0 ? row[i - 1] >> last_bit : carry);
+}
+
+// cells shifted by one to the west, so every bit holds its east neighbor
+inline word_type east_of(const word_type *row, std::size_t i, std::size_t words,
+                         word_type carry) NOEXCEPT
+{
+    return (row[i] >> 1) | (i + 1 < words ? row[i + 1] << last_bit : carry);
+}
+
+// step the words [first, last) of a row, return the changed bits
+// and add the alive cells of the new row to population; the inner words
+// go to the SIMD span if there is one
+template<class Cells>
+word_type step_row(const Cells &cells, span_function span, const word_type *up,
+                   const word_type *mid, const word_type *down, word_type *out,
+                   std::size_t width, std::size_t words, std::size_t first, std::size_t last,
+                   word_type tail_mask, bool wrap, std::size_t &population) NOEXCEPT
+{
+    // neighbors from the other side of the row in toroidal mode
+    std::size_t last_x = width - 1;
+    std::size_t last_pos = last_x % BitGrid::word_bits;
+    auto west_carry = [&](const word_type * row) -> word_type
+    {
+        return wrap ? (row[last_x / BitGrid::word_bits] >> last_pos) & 1 : 0;
+    };
+    auto east_carry = [&](const word_type * row) -> word_type
+    {
+        return wrap ? (row[0] & 1) << last_pos : 0;
+    };
+
+    // the first and the last word need the carries, the rest is vectorized
+    word_type changed = 0;
+    auto edge_word = [&](std::size_t i)
+    {
+        bool last = (i + 1 == words);
+        word_type up_e_carry = last ? east_carry(up) : 0;
+        word_type mid_e_carry = last ? east_carry(mid) : 0;
+        word_type down_e_carry = last ? east_carry(down) : 0;
+
+        out[i] = cells(west_of(up, i, west_carry(up)), up[i],
+                       east_of(up, i, words, up_e_carry),
+                       west_of(mid, i, west_carry(mid)), mid[i],
+                       east_of(mid, i, words, mid_e_carry),
+                       west_of(down, i, west_carry(down)), down[i],
+                       east_of(down, i, words, down_e_carry));
+        if (last)
+        {
+            out[i] &= tail_mask;
+        }
+        changed |= out[i] ^ mid[i];
+        population += popcount(out[i]);
+    };
+
+    std::size_t begin = first;
+    std::size_t end = last;
+    if (begin == 0)
+    {
+        edge_word(0);
+        begin = 1;
+    }
+    if (end == words && end > begin)
+    {
+        edge_word(words - 1);
+        end = words - 1;
+    }
+    if (begin < end)
+    {
+        std::size_t done = span ? span(up, mid, down, out, begin, end, changed, population) : begin;
+        life_span_scalar(cells, up, mid, down, out, done, end, changed, population);
+    }
+
+    return changed;
+}
+
+template<class Cells>
+StepResult step_rows(const Cells &cells, span_function span,
+                     const BitGrid &src, BitGrid &dst, bool bounded,
+                     std::size_t first_row, std::size_t last_row,
+                     std::size_t first_word, std::size_t last_word) NOEXCEPT
+{
+    StepResult result = {0, false};
+    std::size_t width = src.get_width();
+    std::size_t height = src.get_height();
+    if (width == 0 || height == 0)
+    {
+        return result;
+    }
+
+    std::size_t words = src.words_per_row();
+    word_type tail_mask = src.tail_mask();
+
+    word_type changed = 0;
+    for (std::size_t y = first_row; y < last_row; ++y)
+    {
+        const word_type *up = nullptr;
+        const word_type *down = nullptr;
+        if (bounded)
+        {
+            up = (y > 0) ? src.row(y - 1) : src.zero_row();
+            down = (y + 1 < height) ? src.row(y + 1) : src.zero_row();
+        }
+        else
+        {
+            up = src.row(y > 0 ? y - 1 : height - 1);
+            down = src.row(y + 1 < height ? y + 1 : 0);
+        }
+
+        changed |= step_row(cells, span, up, src.row(y), down, dst.row(y), width, words,
+                            first_word, last_word, tail_mask, !bounded, result.population);
+    }
+    result.changed = (changed != 0);
+    return result;
+}
+
+using step_function = StepResult (*)(span_function span,
+                                     const BitGrid &src, BitGrid &dst, bool bounded,
+                                     std::size_t first_row, std::size_t last_row,
+                                     std::size_t first_word, std::size_t last_word);
+
+template<unsigned Birth, unsigned Survival>
+StepResult step_rule(span_function span, const BitGrid &src, BitGrid &dst, bool bounded,
+                     std::size_t first_row, std::size_t last_row,
+                     std::size_t first_word, std::size_t last_word) NOEXCEPT
+{
+    return step_rows(RuleCells<Birth, Survival>(), span, src, dst, bounded,
+                     first_row, last_row, first_word, last_word);
+}
+
+template<unsigned Birth, unsigned Survival>
+struct ScalarStep
+{
+    static step_function get()
+    {
+        return &step_rule<Birth, Survival>;
+    }
+};
+
+} // anonymous
+
+Simd simd_support() NOEXCEPT
+{
+    return supported_simd;
+}
+
+Simd simd() NOEXCEPT
+{
+    return active_simd;
+}
+
+void set_simd(Simd simd) NOEXCEPT
+{
+    if (static_cast<int>(simd) > static_cast<int>(supported_simd))
+    {
+        simd = supported_simd;
+    }
+    active_simd = simd;
+}
+
+const char *simd_name(Simd simd) NOEXCEPT
+{
+    switch (simd)
+    {
+    case Simd::avx2:
+        return "avx2";
+    case Simd::sse2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
+
+StepResult step_bitwise(const BitGrid &src, BitGrid &dst, const Rule &rule, bool bounded,
+                        std::size_t first_row, std::size_t last_row,
+                        std::size_t first_word, std::size_t last_word) NOEXCEPT
+{
+    step_function step = rule_kernel<ScalarStep>(rule.birth(), rule.survival());
+    if (step)
+    {
+        return step(span_for(active_simd, rule), src, dst, bounded,
+                    first_row, last_row, first_word, last_word);
+    }
+    return step_rows(TableCells{rule.table().data()}, nullptr, src, dst, bounded,
+                     first_row, last_row, first_word, last_word);
+}
+
+} // details
+
+} // gol
+
+} // nzs
@@ -0,0 +1,176 @@
+#include "life_kernel.hpp"
+#include "cpp_features.hpp"
+
+// everything below is compiled for AVX2, the function is only called
+// when the CPU supports it (see simd_support())
+#if defined(NZS_X86_SIMD)
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#include <immintrin.h>
+#include "life_logic.hpp"
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace details
+{
+
+namespace
+{
+
+// 256 cells
+struct Avx2Word
+{
+    static const std::size_t lanes = 4;
+
+    __m256i v;
+
+    static inline Avx2Word load(const word_type *p)
+    {
+        return {_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p))};
+    }
+
+    static inline void store(word_type *p, Avx2Word w)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), w.v);
+    }
+
+    static inline Avx2Word west(Avx2Word w, Avx2Word prev)
+    {
+        return {_mm256_or_si256(_mm256_slli_epi64(w.v, 1), _mm256_srli_epi64(prev.v, 63))};
+    }
+
+    static inline Avx2Word east(Avx2Word w, Avx2Word next)
+    {
+        return {_mm256_or_si256(_mm256_srli_epi64(w.v, 1), _mm256_slli_epi64(next.v, 63))};
+    }
+
+    static inline Avx2Word zero()
+    {
+        return {_mm256_setzero_si256()};
+    }
+
+    // alive cells of every 64-bit lane
+    static inline Avx2Word popcount(Avx2Word w)
+    {
+        const __m256i m1 = _mm256_set1_epi8(0x55);
+        const __m256i m2 = _mm256_set1_epi8(0x33);
+        const __m256i m4 = _mm256_set1_epi8(0x0F);
+        __m256i x = w.v;
+        x = _mm256_sub_epi8(x, _mm256_and_si256(_mm256_srli_epi64(x, 1), m1));
+        x = _mm256_add_epi8(_mm256_and_si256(x, m2), _mm256_and_si256(_mm256_srli_epi64(x, 2), m2));
+        x = _mm256_and_si256(_mm256_add_epi8(x, _mm256_srli_epi64(x, 4)), m4);
+        // sum the bytes of every lane
+        return {_mm256_sad_epu8(x, _mm256_setzero_si256())};
+    }
+
+    static inline Avx2Word add(Avx2Word lhs, Avx2Word rhs)
+    {
+        return {_mm256_add_epi64(lhs.v, rhs.v)};
+    }
+
+    // OR of the lanes
+    static inline word_type fold(Avx2Word w)
+    {
+        word_type words[4];
+        store(words, w);
+        return words[0] | words[1] | words[2] | words[3];
+    }
+
+    // sum of the lanes
+    static inline std::size_t sum(Avx2Word w)
+    {
+        word_type words[4];
+        store(words, w);
+        return static_cast<std::size_t>(words[0] + words[1] + words[2] + words[3]);
+    }
+};
+
+inline Avx2Word operator&(Avx2Word lhs, Avx2Word rhs)
+{
+    return {_mm256_and_si256(lhs.v, rhs.v)};
+}
+
+inline Avx2Word operator|(Avx2Word lhs, Avx2Word rhs)
+{
+    return {_mm256_or_si256(lhs.v, rhs.v)};
+}
+
+inline Avx2Word operator^(Avx2Word lhs, Avx2Word rhs)
+{
+    return {_mm256_xor_si256(lhs.v, rhs.v)};
+}
+
+inline Avx2Word operator~(Avx2Word w)
+{
+    return {_mm256_xor_si256(w.v, _mm256_set1_epi32(-1))};
+}
+
+template<unsigned Birth, unsigned Survival>
+std::size_t life_span_avx2(const word_type *up, const word_type *mid, const word_type *down,
+                           word_type *out, std::size_t first, std::size_t last,
+                           word_type &changed, std::size_t &population)
+{
+    return life_span<Avx2Word>(RuleCells<Birth, Survival>(), up, mid, down, out, first, last,
+                           changed, population);
+}
+
+template<unsigned Birth, unsigned Survival>
+struct Avx2Span
+{
+    static span_function get()
+    {
+        return &life_span_avx2<Birth, Survival>;
+    }
+};
+
+} // anonymous
+
+span_function span_avx2(const Rule &rule) NOEXCEPT
+{
+    return rule_kernel<Avx2Span>(rule.birth(), rule.survival());
+}
+
+} // details
+
+} // gol
+
+} // nzs
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#else // NZS_X86_SIMD
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace details
+{
+
+span_function span_avx2(const Rule &) NOEXCEPT
+{
+    return nullptr;
+}
+
+} // details
+
+} // gol
+
+} // nzs
+
+#endif // NZS_X86_SIMD
@@ -0,0 +1,176 @@
+#include "life_kernel.hpp"
+#include "cpp_features.hpp"
+
+// everything below is compiled for SSE2, the function is only called
+// when the CPU supports it (see simd_support())
+#if defined(NZS_X86_SIMD)
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+#include <emmintrin.h>
+#include "life_logic.hpp"
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace details
+{
+
+namespace
+{
+
+// 128 cells
+struct Sse2Word
+{
+    static const std::size_t lanes = 2;
+
+    __m128i v;
+
+    static inline Sse2Word load(const word_type *p)
+    {
+        return {_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))};
+    }
+
+    static inline void store(word_type *p, Sse2Word w)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), w.v);
+    }
+
+    static inline Sse2Word west(Sse2Word w, Sse2Word prev)
+    {
+        return {_mm_or_si128(_mm_slli_epi64(w.v, 1), _mm_srli_epi64(prev.v, 63))};
+    }
+
+    static inline Sse2Word east(Sse2Word w, Sse2Word next)
+    {
+        return {_mm_or_si128(_mm_srli_epi64(w.v, 1), _mm_slli_epi64(next.v, 63))};
+    }
+
+    static inline Sse2Word zero()
+    {
+        return {_mm_setzero_si128()};
+    }
+
+    // alive cells of every 64-bit lane
+    static inline Sse2Word popcount(Sse2Word w)
+    {
+        const __m128i m1 = _mm_set1_epi8(0x55);
+        const __m128i m2 = _mm_set1_epi8(0x33);
+        const __m128i m4 = _mm_set1_epi8(0x0F);
+        __m128i x = w.v;
+        x = _mm_sub_epi8(x, _mm_and_si128(_mm_srli_epi64(x, 1), m1));
+        x = _mm_add_epi8(_mm_and_si128(x, m2), _mm_and_si128(_mm_srli_epi64(x, 2), m2));
+        x = _mm_and_si128(_mm_add_epi8(x, _mm_srli_epi64(x, 4)), m4);
+        // sum the bytes of every lane
+        return {_mm_sad_epu8(x, _mm_setzero_si128())};
+    }
+
+    static inline Sse2Word add(Sse2Word lhs, Sse2Word rhs)
+    {
+        return {_mm_add_epi64(lhs.v, rhs.v)};
+    }
+
+    // OR of the lanes
+    static inline word_type fold(Sse2Word w)
+    {
+        word_type words[2];
+        store(words, w);
+        return words[0] | words[1];
+    }
+
+    // sum of the lanes
+    static inline std::size_t sum(Sse2Word w)
+    {
+        word_type words[2];
+        store(words, w);
+        return static_cast<std::size_t>(words[0] + words[1]);
+    }
+};
+
+inline Sse2Word operator&(Sse2Word lhs, Sse2Word rhs)
+{
+    return {_mm_and_si128(lhs.v, rhs.v)};
+}
+
+inline Sse2Word operator|(Sse2Word lhs, Sse2Word rhs)
+{
+    return {_mm_or_si128(lhs.v, rhs.v)};
+}
+
+inline Sse2Word operator^(Sse2Word lhs, Sse2Word rhs)
+{
+    return {_mm_xor_si128(lhs.v, rhs.v)};
+}
+
+inline Sse2Word operator~(Sse2Word w)
+{
+    return {_mm_xor_si128(w.v, _mm_set1_epi32(-1))};
+}
+
+template<unsigned Birth, unsigned Survival>
+std::size_t life_span_sse2(const word_type *up, const word_type *mid, const word_type *down,
+                           word_type *out, std::size_t first, std::size_t last,
+                           word_type &changed, std::size_t &population)
+{
+    return life_span<Sse2Word>(RuleCells<Birth, Survival>(), up, mid, down, out, first, last,
+                           changed, population);
+}
+
+template<unsigned Birth, unsigned Survival>
+struct Sse2Span
+{
+    static span_function get()
+    {
+        return &life_span_sse2<Birth, Survival>;
+    }
+};
+
+} // anonymous
+
+span_function span_sse2(const Rule &rule) NOEXCEPT
+{
+    return rule_kernel<Sse2Span>(rule.birth(), rule.survival());
+}
+
+} // details
+
+} // gol
+
+} // nzs
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#else // NZS_X86_SIMD
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace details
+{
+
+span_function span_sse2(const Rule &) NOEXCEPT
+{
+    return nullptr;
+}
+
+} // details
+
+} // gol
+
+} // nzs
+
+#endif // NZS_X86_SIMD
@@ -0,0 +1,240 @@
+#include "log.hpp"
+#include "cpp_features.hpp"
+
+#include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+namespace Log
+{
+
+namespace
+{
+
+// number of the records, a power of two
+const std::size_t queue_size = 1024;
+
+// the writer sleeps at most this long, so a missed wake up only delays a line
+const std::chrono::milliseconds idle_wait(50);
+
+// bounded multi producer, single consumer queue of lines: a producer claims a
+// record by moving the head with compare and swap, the sequence of the record
+// tells whether it is free (position), written (position + 1) or being read
+class LineQueue
+{
+public:
+    LineQueue() :
+        head_(0),
+        tail_(0),
+        dropped_(0),
+        sleeping_(false),
+        stop_(false)
+    {
+        for (std::size_t i = 0; i < queue_size; ++i)
+        {
+            records_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        // the statics used by the writer are made first, so they are destroyed
+        // after the last lines are written
+        details::get_ostream();
+        details::get_styles();
+        thread_ = std::thread(&LineQueue::loop, this);
+    }
+
+    // write the queued lines and stop the writer
+    ~LineQueue()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+    LineQueue(const LineQueue &) = delete;
+    LineQueue &operator=(const LineQueue &) = delete;
+
+    void push(const char *text, std::size_t size, bool important)
+    {
+        std::size_t position = head_.load(std::memory_order_relaxed);
+        Record *record = nullptr;
+        while (true)
+        {
+            record = &records_[position % queue_size];
+            std::size_t sequence = record->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence - position);
+            if (difference == 0)
+            {
+                if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (difference < 0)
+            {
+                // full: the writer is behind by a whole queue
+                if (!important)
+                {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                wake();
+                std::this_thread::yield();
+                position = head_.load(std::memory_order_relaxed);
+            }
+            else
+            {
+                position = head_.load(std::memory_order_relaxed);
+            }
+        }
+
+        std::memcpy(record->text, text, size);
+        record->size = size;
+        record->sequence.store(position + 1, std::memory_order_release);
+        if (sleeping_.load(std::memory_order_acquire) && sleeping_.exchange(false))
+        {
+            wake();
+        }
+    }
+
+    // wait until the lines queued before the call are written
+    void flush()
+    {
+        std::size_t target = head_.load(std::memory_order_acquire);
+        while (tail_.load(std::memory_order_acquire) < target)
+        {
+            wake();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    void set_ostream(std::streambuf *sb)
+    {
+        flush();
+        std::lock_guard<std::mutex> lock(stream_mutex_);
+        details::get_ostream().rdbuf(sb);
+    }
+
+private:
+    struct Record
+    {
+        std::atomic<std::size_t> sequence;
+        std::size_t size;
+        char text[details::record_size];
+    };
+
+    Record records_[queue_size];
+    std::atomic<std::size_t> head_;
+    // only the writer moves it, flush() reads it
+    std::atomic<std::size_t> tail_;
+    std::atomic<std::size_t> dropped_;
+    std::atomic<bool> sleeping_;
+    bool stop_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::mutex stream_mutex_;
+    std::thread thread_;
+
+    void wake()
+    {
+        wake_.notify_one();
+    }
+
+    // write the ready records, return the number of them
+    std::size_t drain()
+    {
+        std::lock_guard<std::mutex> lock(stream_mutex_);
+        std::ostream &os = details::get_ostream();
+        std::size_t written = 0;
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Record &record = records_[tail % queue_size];
+            if (record.sequence.load(std::memory_order_acquire) != tail + 1)
+            {
+                break;
+            }
+            os.write(record.text, record.size);
+            record.sequence.store(tail + queue_size, std::memory_order_release);
+            ++tail;
+            ++written;
+            tail_.store(tail, std::memory_order_release);
+        }
+
+        std::size_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+        if (dropped != 0)
+        {
+            os << details::get_styles().begin[WARNING] << dropped
+               << " log lines dropped, the queue was full" << details::get_styles().end;
+        }
+        if (written != 0 || dropped != 0)
+        {
+            // the flush is paid by this thread and only once per batch
+            os.flush();
+        }
+        return written;
+    }
+
+    void loop()
+    {
+        while (true)
+        {
+            if (drain() != 0)
+            {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (stop_)
+            {
+                lock.unlock();
+                drain();
+                return;
+            }
+            sleeping_.store(true);
+            // a line may have arrived before the flag was set
+            std::size_t tail = tail_.load(std::memory_order_relaxed);
+            if (records_[tail % queue_size].sequence.load(std::memory_order_acquire) != tail + 1)
+            {
+                wake_.wait_for(lock, idle_wait);
+            }
+            sleeping_.store(false);
+        }
+    }
+};
+
+LineQueue &get_queue()
+{
+    static LineQueue queue;
+    return queue;
+}
+
+} // anonymous
+
+namespace details
+{
+
+void submit_line(LineStream &line, const std::string &end, bool important)
+{
+    line.buffer.finish(end);
+    get_queue().push(line.buffer.data(), line.buffer.size(), important);
+}
+
+void set_ostream(std::streambuf *sb)
+{
+    get_queue().set_ostream(sb);
+}
+
+} // details
+
+void flush()
+{
+    get_queue().flush();
+}
+
+} // log
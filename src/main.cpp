@@ -1,4 +1,8 @@
 #include "game_gui.hpp"
+#include "checkpoint.hpp"
+#include "life_kernel.hpp"
+#include "timing.hpp"
+#include "trace.hpp"
 #include "log.hpp"
 
 #include <GLFW/glfw3.h>
@@ -8,12 +12,22 @@
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <stdexcept>
+#include <chrono>
 
 std::size_t WINDOW_WIDTH = 1280;
 std::size_t WINDOW_HEIGHT = 720;
 std::size_t ROW = 80;
 std::size_t COLUMN = 48;
 bool IS_FULL_SCREEN = false;
+std::size_t THREADS = 1;
+nzs::gol::Rule RULE;
+std::string PATTERN;
+std::vector<std::string> BRUSH_FILES;
+nzs::gol::CheckpointPolicy AUTOSAVE;
+bool RESUME = false;
+std::string TIMERS;
+std::string TRACE;
 
 class initGLFW
 {
@@ -79,7 +93,10 @@ void parseCLA(int argc, const char *argv[])
         {
             std::cout << "USAGE: " + std::string(argv[0])
                       << " [-w|--width ARG] [-h|--height ARG] [-r|--row ARG]"
-                      << " [-c|--column ARG] [-f|--fullscreen 0|1|false|true] [--help]" << std::endl;
+                      << " [-c|--column ARG] [-f|--fullscreen 0|1|false|true] [-t|--threads ARG]"
+                      << " [--rule ARG] [-p|--pattern FILE] [--brush FILE]"
+                      << " [--autosave-generations ARG] [--autosave-seconds ARG] [--autosave-keep ARG]"
+                      << " [--autosave-prefix PATH] [--resume] [--timers FILE] [--trace FILE] [--help]" << std::endl;
 
             std::cout << std::endl << "Option Descriptions" << std::endl << std::endl;
 
@@ -88,6 +105,17 @@ void parseCLA(int argc, const char *argv[])
             std::cout << std::setw(15) << "\t-h [ --height ]" << "\t\t"  << "Set the window height." << std::endl;
             std::cout << std::setw(15) << "\t-r [ --row ]"    << "\t\t"  << "Set the number of rows." << std::endl;
             std::cout << std::setw(15) << "\t-c [ --column ]" << "\t\t" << "Set the number of columns." << std::endl;
+            std::cout << std::setw(15) << "\t-t [ --threads ]" << "\t" << "Set the number of stepping threads (0 = one per core)." << std::endl;
+            std::cout << std::setw(15) << "\t--rule"         << "\t\t"   << "Set the rule in B/S notation (default B3/S23)." << std::endl;
+            std::cout << std::setw(15) << "\t-p [ --pattern ]" << "\t" << "Load the first generation from an RLE (.rle), macrocell (.mc), checkpoint (.gol) or plaintext file." << std::endl;
+            std::cout << std::setw(15) << "\t--brush"        << "\t\t"   << "Add the pattern of the file as a brush (repeatable)." << std::endl;
+            std::cout << std::setw(15) << "\t--autosave-generations" << "\t" << "Write a checkpoint after this many generations (0 = never)." << std::endl;
+            std::cout << std::setw(15) << "\t--autosave-seconds" << "\t" << "Write a checkpoint after this many seconds while running (0 = never)." << std::endl;
+            std::cout << std::setw(15) << "\t--autosave-keep" << "\t"     << "Keep the last this many checkpoints (default 3)." << std::endl;
+            std::cout << std::setw(15) << "\t--autosave-prefix" << "\t"   << "Write the checkpoints to PATH.<slot>.gol (default ./autosave)." << std::endl;
+            std::cout << std::setw(15) << "\t--resume"       << "\t\t"   << "Continue from the newest checkpoint of the autosave prefix." << std::endl;
+            std::cout << std::setw(15) << "\t--timers"       << "\t\t"   << "Write the times of the frame phases to a JSON file at the exit." << std::endl;
+            std::cout << std::setw(15) << "\t--trace"        << "\t\t"   << "Trace the whole run and write it to a Chrome trace (JSON) file at the exit." << std::endl;
             std::cout << std::setw(15) << "\t--help"         << "\t\t"   << "Print this message and exit." << std::endl;
             std::exit(EXIT_SUCCESS);
         }
@@ -112,6 +140,69 @@ void parseCLA(int argc, const char *argv[])
             fetch_value(args[i], COLUMN);
             Log::verbose("column set to:", COLUMN);
         }
+        else if ((args[i] == "-t" || args[i] == "--threads") && ++i < args.size())
+        {
+            fetch_value(args[i], THREADS);
+            Log::verbose("threads set to:", THREADS);
+        }
+        else if (args[i] == "--rule" && ++i < args.size())
+        {
+            try
+            {
+                RULE = nzs::gol::Rule::parse(args[i]);
+                Log::verbose("rule set to:", RULE.to_string());
+            }
+            catch (const std::invalid_argument &)
+            {
+                Log::warning("Invalid rule:", args[i]);
+            }
+        }
+        else if ((args[i] == "-p" || args[i] == "--pattern") && ++i < args.size())
+        {
+            PATTERN = args[i];
+            Log::verbose("pattern set to:", PATTERN);
+        }
+        else if (args[i] == "--brush" && ++i < args.size())
+        {
+            BRUSH_FILES.push_back(args[i]);
+            Log::verbose("brush file added:", args[i]);
+        }
+        else if (args[i] == "--autosave-generations" && ++i < args.size())
+        {
+            fetch_value(args[i], AUTOSAVE.generations);
+            Log::verbose("autosave generations set to:", AUTOSAVE.generations);
+        }
+        else if (args[i] == "--autosave-seconds" && ++i < args.size())
+        {
+            std::size_t seconds = 0;
+            fetch_value(args[i], seconds);
+            AUTOSAVE.seconds = std::chrono::seconds(seconds);
+            Log::verbose("autosave seconds set to:", seconds);
+        }
+        else if (args[i] == "--autosave-keep" && ++i < args.size())
+        {
+            fetch_value(args[i], AUTOSAVE.keep);
+            Log::verbose("autosave keep set to:", AUTOSAVE.keep);
+        }
+        else if (args[i] == "--autosave-prefix" && ++i < args.size())
+        {
+            AUTOSAVE.prefix = args[i];
+            Log::verbose("autosave prefix set to:", AUTOSAVE.prefix);
+        }
+        else if (args[i] == "--resume")
+        {
+            RESUME = true;
+        }
+        else if (args[i] == "--timers" && ++i < args.size())
+        {
+            TIMERS = args[i];
+            Log::verbose("timers file set to:", TIMERS);
+        }
+        else if (args[i] == "--trace" && ++i < args.size())
+        {
+            TRACE = args[i];
+            Log::verbose("trace file set to:", TRACE);
+        }
         else if ((args[i] == "-f" || args[i] == "--fullscreen") && ++i < args.size())
         {
             int is_fullscreen = string_to_int(args[i]);
@@ -139,10 +230,34 @@ int main(int argc, char const *argv[])
 {
     Log::init(argc, argv);
     parseCLA(argc, argv);
+    Log::debug("stepping kernel:", nzs::gol::details::simd_name(nzs::gol::details::simd()));
+    if (RESUME)
+    {
+        std::string latest = nzs::gol::latest_checkpoint(AUTOSAVE);
+        if (latest.empty())
+        {
+            Log::warning("no checkpoint to resume:", AUTOSAVE.prefix);
+        }
+        else
+        {
+            PATTERN = latest;
+        }
+    }
+    nzs::gol::set_tracing(!TRACE.empty());
     initGLFW raii;
 
-    nzs::gol::GameGui game {WINDOW_WIDTH, WINDOW_HEIGHT, ROW, COLUMN, IS_FULL_SCREEN};
+    nzs::gol::GameGui game {WINDOW_WIDTH, WINDOW_HEIGHT, ROW, COLUMN, IS_FULL_SCREEN, THREADS, RULE,
+                            PATTERN, BRUSH_FILES, AUTOSAVE};
     game.run();
 
+    if (!TIMERS.empty() && !nzs::gol::write_timers(TIMERS))
+    {
+        Log::error("cannot write file:", TIMERS);
+    }
+    if (!TRACE.empty() && !nzs::gol::write_trace(TRACE))
+    {
+        Log::error("cannot write file:", TRACE);
+    }
+
     return EXIT_SUCCESS;
 }
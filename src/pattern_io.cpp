@@ -0,0 +1,671 @@
+#include "pattern_io.hpp"
+#include "checkpoint.hpp"
+#include "log.hpp"
+#include "cpp_features.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace
+{
+
+// reads the file in large blocks instead of lines
+class BlockReader
+{
+public:
+    explicit BlockReader(std::istream &stream) :
+        stream_(stream),
+        buffer_(1 << 16),
+        pos_(0),
+        size_(0)
+    {
+    }
+
+    inline int peek()
+    {
+        if (pos_ == size_ && !fill())
+        {
+            return EOF;
+        }
+        return static_cast<unsigned char>(buffer_[pos_]);
+    }
+
+    inline int get()
+    {
+        int c = peek();
+        if (c != EOF)
+        {
+            ++pos_;
+        }
+        return c;
+    }
+
+private:
+    std::istream &stream_;
+    std::vector<char> buffer_;
+    std::size_t pos_;
+    std::size_t size_;
+
+    bool fill()
+    {
+        stream_.read(buffer_.data(), buffer_.size());
+        size_ = static_cast<std::size_t>(stream_.gcount());
+        pos_ = 0;
+        return size_ != 0;
+    }
+};
+
+void skip_line(BlockReader &in)
+{
+    int c;
+    while ((c = in.get()) != EOF && c != '\n')
+    {
+    }
+}
+
+std::string trim(const std::string &text)
+{
+    std::size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos)
+    {
+        return std::string();
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+// "x = 3, y = 3, rule = B3/S23"
+bool read_rle_header(const std::string &line, PatternInfo &info)
+{
+    std::istringstream fields(line);
+    std::string field;
+    bool has_x = false;
+    bool has_y = false;
+    while (std::getline(fields, field, ','))
+    {
+        std::size_t equal = field.find('=');
+        // the ":T100,100" like bounded grid suffix of a Golly rule contains a comma
+        if (equal == std::string::npos)
+        {
+            continue;
+        }
+        std::string key = trim(field.substr(0, equal));
+        std::string value = trim(field.substr(equal + 1));
+        std::istringstream number(value);
+        if (key == "x")
+        {
+            has_x = static_cast<bool>(number >> info.width);
+        }
+        else if (key == "y")
+        {
+            has_y = static_cast<bool>(number >> info.height);
+        }
+        else if (key == "rule")
+        {
+            // the bounded grid suffix is ignored
+            try
+            {
+                info.rule = Rule::parse(value.substr(0, value.find(':')));
+                info.has_rule = true;
+            }
+            catch (const std::invalid_argument &)
+            {
+                Log::warning("unsupported rule:", value);
+            }
+        }
+    }
+    return has_x && has_y;
+}
+
+// the bounding box of the cells starting at (0, 0)
+void fit(const Brush &cells, PatternInfo &info)
+{
+    for (const auto &cell : cells)
+    {
+        info.width = std::max(info.width, static_cast<std::size_t>(cell.get_x() + 1));
+        info.height = std::max(info.height, static_cast<std::size_t>(cell.get_y() + 1));
+    }
+}
+
+// collects the runs into lines of at most 70 characters
+class RleWriter
+{
+public:
+    explicit RleWriter(std::ostream &stream) :
+        stream_(stream)
+    {
+    }
+
+    void run(std::size_t count, char tag)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        // the digits are written backwards
+        char token[24];
+        std::size_t length = 0;
+        token[length++] = tag;
+        for (std::size_t digits = count > 1 ? count : 0; digits != 0; digits /= 10)
+        {
+            token[length++] = static_cast<char>('0' + digits % 10);
+        }
+        if (!line_.empty() && line_.size() + length > max_line)
+        {
+            flush();
+        }
+        line_.append(std::reverse_iterator<char *>(token + length),
+                     std::reverse_iterator<char *>(token));
+    }
+
+    void flush()
+    {
+        line_ += '\n';
+        stream_.write(line_.data(), line_.size());
+        line_.clear();
+    }
+
+private:
+    static const std::size_t max_line = 70;
+
+    std::ostream &stream_;
+    std::string line_;
+};
+
+const std::size_t RleWriter::max_line;
+
+// the first x from which the cells of the row equal alive, width if there is none
+std::size_t find_cell(const BitGrid::word_type *row, std::size_t x, std::size_t width, bool alive)
+{
+    const std::size_t bits = BitGrid::word_bits;
+    while (x < width)
+    {
+        BitGrid::word_type word = alive ? row[x / bits] : ~row[x / bits];
+        word >>= x % bits;
+        if (word != 0)
+        {
+            return std::min(width, x + details::lowest_bit(word));
+        }
+        x = (x / bits + 1) * bits;
+    }
+    return width;
+}
+
+bool has_extension(const std::string &file_path, const std::string &extension)
+{
+    if (file_path.size() < extension.size())
+    {
+        return false;
+    }
+    std::string end = file_path.substr(file_path.size() - extension.size());
+    std::transform(end.begin(), end.end(), end.begin(), ::tolower);
+    return end == extension;
+}
+
+} // anonymous
+
+bool load_plaintext(const std::string &file_path, Brush &cells)
+{
+    std::ifstream file(file_path);
+    if (!file.is_open())
+    {
+        Log::error("file not found:", file_path);
+        return false;
+    }
+
+    cells.clear();
+    std::string line;
+    int y = 0;
+    while (std::getline(file, line))
+    {
+        // ignore comment
+        if (!line.empty() && line[0] == '!')
+        {
+            continue;
+        }
+
+        for (std::size_t x = 0; x < line.size(); ++x)
+        {
+            if (line[x] == 'O' || line[x] == '*')
+            {
+                cells.push_back({static_cast<int>(x), y});
+            }
+            else if (line[x] != '.' && line[x] != '\r')
+            {
+                Log::warning("bad cell:", line[x], "in line", y + 1, "of", file_path);
+            }
+        }
+        ++y;
+    }
+    Log::debug("pattern loaded:", file_path, "cells:", cells.size());
+    return true;
+}
+
+bool save_plaintext(const std::string &file_path, const GameOfLife &game)
+{
+    std::ofstream file(file_path);
+    if (!file.is_open())
+    {
+        Log::error("cannot open file:", file_path);
+        return false;
+    }
+
+    const BitGrid &grid = game.grid();
+    file << "! generation " << game.generation() << "\n";
+    std::string line;
+    for (std::size_t y = 0; y < grid.get_height(); ++y)
+    {
+        // the dead cells at the end of the line are left out
+        line.clear();
+        std::size_t length = 0;
+        for (std::size_t x = 0; x < grid.get_width(); ++x)
+        {
+            bool alive = grid.get(x, y);
+            line += alive ? 'O' : '.';
+            if (alive)
+            {
+                length = x + 1;
+            }
+        }
+        file.write(line.data(), length);
+        file << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+bool load_rle(const std::string &file_path, Brush &cells, PatternInfo &info)
+{
+    std::ifstream file(file_path, std::ios::binary);
+    if (!file.is_open())
+    {
+        Log::error("file not found:", file_path);
+        return false;
+    }
+
+    cells.clear();
+    info = PatternInfo{0, 0, false, Rule()};
+    BlockReader in(file);
+
+    // the comments and the header are before the cells
+    bool has_header = false;
+    int c;
+    while ((c = in.peek()) != EOF)
+    {
+        if (c == '#')
+        {
+            skip_line(in);
+        }
+        else if (std::isspace(c))
+        {
+            in.get();
+        }
+        else if (c == 'x')
+        {
+            std::string line;
+            while ((c = in.get()) != EOF && c != '\n')
+            {
+                line += static_cast<char>(c);
+            }
+            if (!read_rle_header(line, info))
+            {
+                Log::error("bad header:", line, "in", file_path);
+                return false;
+            }
+            has_header = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    // <run count><tag> items, the count is 1 if it is missing
+    std::size_t count = 0;
+    int x = 0;
+    int y = 0;
+    bool finished = false;
+    while (!finished && (c = in.get()) != EOF)
+    {
+        if (c >= '0' && c <= '9')
+        {
+            count = count * 10 + (c - '0');
+            if (count > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+            {
+                Log::error("too long run in", file_path);
+                return false;
+            }
+            continue;
+        }
+        if (std::isspace(c))
+        {
+            continue;
+        }
+
+        int run = count == 0 ? 1 : static_cast<int>(count);
+        count = 0;
+        switch (c)
+        {
+        case 'b':
+        case '.':
+            x += run;
+            break;
+        case '$':
+            x = 0;
+            y += run;
+            break;
+        case '!':
+            finished = true;
+            break;
+        case '#':
+            skip_line(in);
+            break;
+        default:
+            // the other states of multi-state rules are alive too
+            if (c == 'o' || (c >= 'A' && c <= 'X'))
+            {
+                for (int i = 0; i < run; ++i)
+                {
+                    cells.push_back({x++, y});
+                }
+            }
+            else
+            {
+                Log::error("bad cell:", static_cast<char>(c), "in line", y + 1, "of", file_path);
+                return false;
+            }
+        }
+    }
+    if (!finished)
+    {
+        Log::warning("missing '!' at the end of", file_path);
+    }
+    if (!has_header)
+    {
+        Log::warning("missing header in", file_path);
+    }
+    // the size grows if the cells do not fit in the header
+    fit(cells, info);
+
+    Log::debug("pattern loaded:", file_path, "cells:", cells.size());
+    return true;
+}
+
+bool save_rle(const std::string &file_path, const GameOfLife &game)
+{
+    std::ofstream file(file_path, std::ios::binary);
+    if (!file.is_open())
+    {
+        Log::error("cannot open file:", file_path);
+        return false;
+    }
+
+    const BitGrid &grid = game.grid();
+    std::size_t width = grid.get_width();
+    file << "#C generation " << game.generation() << "\n";
+    file << "x = " << width << ", y = " << grid.get_height()
+         << ", rule = " << game.get_rule().to_string() << "\n";
+
+    // the dead cells at the end of the lines and the empty lines at the end are left out,
+    // the line ends are written before the next alive cell
+    RleWriter out(file);
+    std::size_t line_ends = 0;
+    for (std::size_t y = 0; y < grid.get_height(); ++y)
+    {
+        const BitGrid::word_type *row = grid.row(y);
+        std::size_t x = 0;
+        std::size_t start;
+        while ((start = find_cell(row, x, width, true)) < width)
+        {
+            std::size_t end = find_cell(row, start, width, false);
+            out.run(line_ends, '$');
+            line_ends = 0;
+            out.run(start - x, 'b');
+            out.run(end - start, 'o');
+            x = end;
+        }
+        ++line_ends;
+    }
+    out.run(1, '!');
+    out.flush();
+    return static_cast<bool>(file);
+}
+
+bool load_macrocell(const std::string &file_path, HashLife &life)
+{
+    std::ifstream file(file_path, std::ios::binary);
+    if (!file.is_open())
+    {
+        Log::error("file not found:", file_path);
+        return false;
+    }
+
+    std::string rule;
+    if (!life.read_macrocell(file, rule))
+    {
+        Log::error("bad macrocell file:", file_path);
+        return false;
+    }
+    // the engine calculates B3/S23 only
+    bool supported = rule.empty();
+    try
+    {
+        supported = supported || HashLife::supports(Rule::parse(rule.substr(0, rule.find(':'))));
+    }
+    catch (const std::invalid_argument &)
+    {
+    }
+    if (!supported)
+    {
+        Log::error("the rule of", file_path, "is not supported by HashLife:", rule);
+        life.clear();
+        return false;
+    }
+    Log::debug("pattern loaded:", file_path, "nodes:", life.node_count());
+    return true;
+}
+
+bool save_macrocell(const std::string &file_path, const HashLife &life)
+{
+    std::ofstream file(file_path, std::ios::binary);
+    if (!file.is_open())
+    {
+        Log::error("cannot open file:", file_path);
+        return false;
+    }
+
+    life.write_macrocell(file);
+    return static_cast<bool>(file);
+}
+
+bool load_macrocell(const std::string &file_path, Brush &cells, PatternInfo &info)
+{
+    std::ifstream file(file_path, std::ios::binary);
+    if (!file.is_open())
+    {
+        Log::error("file not found:", file_path);
+        return false;
+    }
+
+    HashLife life;
+    std::string rule;
+    if (!life.read_macrocell(file, rule))
+    {
+        Log::error("bad macrocell file:", file_path);
+        return false;
+    }
+
+    info = PatternInfo{0, 0, false, Rule()};
+    if (!rule.empty())
+    {
+        try
+        {
+            info.rule = Rule::parse(rule.substr(0, rule.find(':')));
+            info.has_rule = true;
+        }
+        catch (const std::invalid_argument &)
+        {
+            Log::warning("unsupported rule:", rule);
+        }
+    }
+
+    std::vector<Position64> plane;
+    life.get_cells(plane);
+    cells.clear();
+    if (plane.empty())
+    {
+        return true;
+    }
+
+    // move the top left corner of the bounding box to (0, 0)
+    Position64 min = plane[0];
+    Position64 max = plane[0];
+    for (const auto &cell : plane)
+    {
+        min = {std::min(min.get_x(), cell.get_x()), std::min(min.get_y(), cell.get_y())};
+        max = {std::max(max.get_x(), cell.get_x()), std::max(max.get_y(), cell.get_y())};
+    }
+    if (max.get_x() - min.get_x() >= std::numeric_limits<int>::max() ||
+            max.get_y() - min.get_y() >= std::numeric_limits<int>::max())
+    {
+        Log::error("too large pattern for a grid:", file_path);
+        return false;
+    }
+
+    cells.reserve(plane.size());
+    for (const auto &cell : plane)
+    {
+        cells.push_back({static_cast<int>(cell.get_x() - min.get_x()),
+                         static_cast<int>(cell.get_y() - min.get_y())});
+    }
+    fit(cells, info);
+    Log::debug("pattern loaded:", file_path, "cells:", cells.size());
+    return true;
+}
+
+bool save_macrocell(const std::string &file_path, const GameOfLife &game)
+{
+    std::ofstream file(file_path, std::ios::binary);
+    if (!file.is_open())
+    {
+        Log::error("cannot open file:", file_path);
+        return false;
+    }
+
+    const BitGrid &grid = game.grid();
+    HashLife life;
+    life.set_cells(grid, {-static_cast<std::int64_t>(grid.get_width() / 2),
+                          -static_cast<std::int64_t>(grid.get_height() / 2)});
+    life.set_generation(game.generation());
+    life.write_macrocell(file, game.get_rule().to_string());
+    return static_cast<bool>(file);
+}
+
+bool load_pattern(const std::string &file_path, Brush &cells, PatternInfo &info)
+{
+    if (has_extension(file_path, ".rle"))
+    {
+        return load_rle(file_path, cells, info);
+    }
+    if (has_extension(file_path, ".mc"))
+    {
+        return load_macrocell(file_path, cells, info);
+    }
+
+    info = PatternInfo{0, 0, false, Rule()};
+    if (!load_plaintext(file_path, cells))
+    {
+        return false;
+    }
+    fit(cells, info);
+    return true;
+}
+
+bool save_pattern(const std::string &file_path, const GameOfLife &game)
+{
+    if (has_extension(file_path, ".rle"))
+    {
+        return save_rle(file_path, game);
+    }
+    if (has_extension(file_path, ".mc"))
+    {
+        return save_macrocell(file_path, game);
+    }
+    if (has_extension(file_path, ".gol"))
+    {
+        return save_checkpoint(file_path, make_checkpoint(game));
+    }
+    return save_plaintext(file_path, game);
+}
+
+bool load_board(const std::string &file_path, GameOfLife &game)
+{
+    if (has_extension(file_path, ".gol"))
+    {
+        Checkpoint checkpoint{BitGrid(0, 0), 0, false, Rule()};
+        if (!load_checkpoint(file_path, checkpoint))
+        {
+            return false;
+        }
+        restore(game, std::move(checkpoint));
+        return true;
+    }
+
+    Brush cells;
+    PatternInfo info;
+    if (!load_pattern(file_path, cells, info))
+    {
+        return false;
+    }
+
+    game.clear();
+    std::size_t width = std::max(game.get_width(), info.width);
+    std::size_t height = std::max(game.get_height(), info.height);
+    if (width != game.get_width() || height != game.get_height())
+    {
+        Log::verbose("grid resized to", width, "x", height);
+        game.resize(width, height);
+    }
+    if (info.has_rule)
+    {
+        game.set_rule(info.rule);
+    }
+    place(game, cells, {static_cast<int>((width - info.width) / 2),
+                        static_cast<int>((height - info.height) / 2)});
+    return true;
+}
+
+Brush centered(const Brush &cells, const PatternInfo &info)
+{
+    Position center(static_cast<int>(info.width / 2), static_cast<int>(info.height / 2));
+    Brush brush;
+    brush.reserve(cells.size());
+    for (const auto &cell : cells)
+    {
+        brush.push_back({cell.get_x() - center.get_x(), cell.get_y() - center.get_y()});
+    }
+    return brush;
+}
+
+void place(GameOfLife &game, const Brush &cells, const Position &offset)
+{
+    for (const auto &cell : cells)
+    {
+        game.born(cell + offset);
+    }
+}
+
+} // gol
+
+} // nzs
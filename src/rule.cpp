@@ -0,0 +1,139 @@
+#include "rule.hpp"
+#include "cpp_features.hpp"
+
+#include <cctype>
+#include <stdexcept>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace
+{
+
+const std::uint16_t all_counts = (1 << 9) - 1;
+const std::size_t cell_bit = 4;
+
+inline bool is_digit(char c)
+{
+    return std::isdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+// read the neighbor counts from pos until the first non-digit into mask
+void read_counts(const std::string &rule, std::size_t &pos, std::uint16_t &mask)
+{
+    for (; pos < rule.size() && is_digit(rule[pos]); ++pos)
+    {
+        int count = rule[pos] - '0';
+        if (count > 8)
+        {
+            throw std::invalid_argument("Rule::parse: invalid neighbor count in " + rule);
+        }
+        mask |= 1 << count;
+    }
+}
+
+std::string counts_to_string(std::uint16_t mask)
+{
+    std::string counts;
+    for (int count = 0; count <= 8; ++count)
+    {
+        if ((mask >> count) & 1)
+        {
+            counts += static_cast<char>('0' + count);
+        }
+    }
+    return counts;
+}
+
+} // anonymous
+
+Rule::Rule() :
+    Rule(1 << 3, (1 << 2) | (1 << 3))
+{
+}
+
+Rule::Rule(std::uint16_t birth, std::uint16_t survival) :
+    birth_(birth & all_counts),
+    survival_(survival & all_counts)
+{
+    for (std::size_t i = 0; i < table_.size(); ++i)
+    {
+        std::size_t neighbors = 0;
+        for (std::size_t bit = 0; bit < 9; ++bit)
+        {
+            if (bit != cell_bit && ((i >> bit) & 1))
+            {
+                ++neighbors;
+            }
+        }
+        table_[i] = next((i >> cell_bit) & 1, neighbors);
+    }
+}
+
+Rule Rule::parse(const std::string &rule)
+{
+    std::uint16_t birth = 0;
+    std::uint16_t survival = 0;
+    std::size_t pos = 0;
+
+    // old survival/birth form
+    if (!rule.empty() && (is_digit(rule[0]) || rule[0] == '/'))
+    {
+        read_counts(rule, pos, survival);
+        if (pos == rule.size() || rule[pos] != '/')
+        {
+            throw std::invalid_argument("Rule::parse: invalid rule " + rule);
+        }
+        read_counts(rule, ++pos, birth);
+        if (pos != rule.size())
+        {
+            throw std::invalid_argument("Rule::parse: invalid rule " + rule);
+        }
+        return Rule(birth, survival);
+    }
+
+    bool has_birth = false;
+    bool has_survival = false;
+    while (pos < rule.size())
+    {
+        char part = static_cast<char>(std::toupper(static_cast<unsigned char>(rule[pos++])));
+        if (part == 'B' && !has_birth)
+        {
+            has_birth = true;
+            read_counts(rule, pos, birth);
+        }
+        else if (part == 'S' && !has_survival)
+        {
+            has_survival = true;
+            read_counts(rule, pos, survival);
+        }
+        else
+        {
+            throw std::invalid_argument("Rule::parse: invalid rule " + rule);
+        }
+
+        // the parts are separated by an optional slash
+        if (pos + 1 < rule.size() && rule[pos] == '/')
+        {
+            ++pos;
+        }
+    }
+
+    if (!has_birth || !has_survival)
+    {
+        throw std::invalid_argument("Rule::parse: invalid rule " + rule);
+    }
+    return Rule(birth, survival);
+}
+
+std::string Rule::to_string() const
+{
+    return "B" + counts_to_string(birth_) + "/S" + counts_to_string(survival_);
+}
+
+} // gol
+
+} // nzs
@@ -0,0 +1,225 @@
+#include "simulation.hpp"
+#include "trace.hpp"
+#include "log.hpp"
+#include "cpp_features.hpp"
+
+#include <algorithm>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace
+{
+
+using clock_type = std::chrono::steady_clock;
+
+// at most one generation per 60 Hz frame like the old render loop
+const std::chrono::milliseconds min_interval(16);
+
+// stepping time between two snapshots in max speed mode, the rest of the 16.6 ms
+// frame is left for the copy and the commands
+const std::chrono::milliseconds frame_budget(14);
+
+// the generations/s is measured over this time
+const std::chrono::milliseconds rate_period(500);
+
+} // anonymous
+
+Simulation::Simulation(std::size_t width, std::size_t height) :
+    game_(width, height),
+    snapshots_(Snapshot{BitGrid(width, height), 0, 0, 0, 0.0}),
+    running_(false),
+    interval_(200),
+    max_speed_(false),
+    stop_(false),
+    generations_per_second_(0.0)
+{
+    publish();
+    thread_ = std::thread(&Simulation::loop, this);
+}
+
+Simulation::~Simulation()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void Simulation::post(command_type command)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        commands_.push_back(std::move(command));
+    }
+    wake_.notify_one();
+}
+
+void Simulation::set_running(bool running)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = running;
+    }
+    wake_.notify_one();
+}
+
+void Simulation::set_interval(std::chrono::milliseconds interval)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        interval_ = interval;
+    }
+    wake_.notify_one();
+}
+
+void Simulation::set_max_speed(bool max_speed)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        max_speed_ = max_speed;
+    }
+    wake_.notify_one();
+}
+
+void Simulation::set_autosave(const CheckpointPolicy &policy)
+{
+    post([this, policy](GameOfLife &)
+    {
+        autosave_.reset(policy.enabled() ? new AutoCheckpoint(policy) : nullptr);
+    });
+}
+
+void Simulation::rewind(std::size_t steps)
+{
+    post([this, steps](GameOfLife & game)
+    {
+        history_.rewind(steps, game);
+    });
+}
+
+void Simulation::loop()
+{
+    set_thread_name("simulation");
+    std::vector<command_type> commands;
+    auto next_step = clock_type::now();
+    std::size_t published = game_.version();
+    auto rate_start = clock_type::now();
+    std::size_t rate_generation = game_.generation();
+    while (true)
+    {
+        bool playing = false;
+        bool step = false;
+        bool max_speed = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // sleep until a command arrives or the next generation is due
+            auto woken = [this]()
+            {
+                return stop_ || !commands_.empty();
+            };
+            if (!running_)
+            {
+                // the generations/s of the last run is cleared before sleeping
+                wake_.wait(lock, [&]()
+                {
+                    return woken() || running_ || generations_per_second_ != 0.0;
+                });
+            }
+            else if (!max_speed_)
+            {
+                wake_.wait_until(lock, next_step, woken);
+            }
+            // in max speed mode the commands are taken between the batches
+
+            if (stop_)
+            {
+                return;
+            }
+            commands.swap(commands_);
+            playing = running_;
+            max_speed = max_speed_;
+            if (playing && (max_speed || clock_type::now() >= next_step))
+            {
+                step = true;
+                next_step = clock_type::now() + std::max(interval_, min_interval);
+            }
+        }
+
+        if (!commands.empty())
+        {
+            ScopedTrace trace("commands", "simulation", "count", static_cast<std::int64_t>(commands.size()));
+            for (auto &command : commands)
+            {
+                command(game_);
+            }
+            commands.clear();
+        }
+
+        if (step)
+        {
+            auto deadline = clock_type::now() + frame_budget;
+            do
+            {
+                // the edits before the step are an own state in the history
+                history_.push(game_);
+                game_.next();
+                history_.push(game_);
+            }
+            while (max_speed && clock_type::now() < deadline);
+
+            NZS_LOG_VERBOSE("generation:", game_.generation(),
+                            "population:", game_.population(),
+                            "skip ratio:", game_.stats().skip_ratio());
+            if (autosave_)
+            {
+                autosave_->update(game_);
+            }
+        }
+
+        // generations/s of the last period, clear() restarts the generations
+        auto now = clock_type::now();
+        double rate = generations_per_second_;
+        if (!playing || game_.generation() < rate_generation)
+        {
+            generations_per_second_ = 0.0;
+            rate_start = now;
+            rate_generation = game_.generation();
+        }
+        else if (now - rate_start >= rate_period)
+        {
+            double seconds = std::chrono::duration<double>(now - rate_start).count();
+            generations_per_second_ = (game_.generation() - rate_generation) / seconds;
+            rate_start = now;
+            rate_generation = game_.generation();
+        }
+
+        if (game_.version() != published || generations_per_second_ != rate)
+        {
+            publish();
+            published = game_.version();
+        }
+    }
+}
+
+void Simulation::publish()
+{
+    ScopedTrace trace("publish", "simulation", "generation", static_cast<std::int64_t>(game_.generation()));
+    Snapshot &snapshot = snapshots_.back();
+    // the copy reuses the memory of the slot if the size did not change
+    snapshot.grid = game_.grid();
+    snapshot.generation = game_.generation();
+    snapshot.population = game_.population();
+    snapshot.version = game_.version();
+    snapshot.generations_per_second = generations_per_second_;
+    snapshots_.publish();
+}
+
+} // gol
+
+} // nzs
@@ -0,0 +1,186 @@
+#include "soup_search.hpp"
+#include "cpp_features.hpp"
+
+#include <random>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <algorithm>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace
+{
+
+// the seeds left for a thread: the owner takes from the front, the others
+// steal from the back
+struct SeedRange
+{
+    std::mutex mutex;
+    std::uint64_t begin;
+    std::uint64_t end;
+};
+
+bool take(SeedRange &range, std::uint64_t &seed)
+{
+    std::lock_guard<std::mutex> lock(range.mutex);
+    if (range.begin == range.end)
+    {
+        return false;
+    }
+    seed = range.begin++;
+    return true;
+}
+
+// move half of the seeds of the fullest other range to the own range
+bool steal(std::vector<SeedRange> &ranges, std::size_t thief)
+{
+    while (true)
+    {
+        std::size_t victim = thief;
+        std::uint64_t most = 0;
+        for (std::size_t i = 0; i < ranges.size(); ++i)
+        {
+            if (i == thief)
+            {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(ranges[i].mutex);
+            if (ranges[i].end - ranges[i].begin > most)
+            {
+                most = ranges[i].end - ranges[i].begin;
+                victim = i;
+            }
+        }
+        if (victim == thief)
+        {
+            return false;
+        }
+
+        // the victim may have taken the rest since the count
+        std::lock(ranges[thief].mutex, ranges[victim].mutex);
+        std::lock_guard<std::mutex> thief_lock(ranges[thief].mutex, std::adopt_lock);
+        std::lock_guard<std::mutex> victim_lock(ranges[victim].mutex, std::adopt_lock);
+        std::uint64_t left = ranges[victim].end - ranges[victim].begin;
+        if (left == 0)
+        {
+            continue;
+        }
+        std::uint64_t stolen = (left + 1) / 2;
+        ranges[thief].begin = ranges[victim].end - stolen;
+        ranges[thief].end = ranges[victim].end;
+        ranges[victim].end -= stolen;
+        return true;
+    }
+}
+
+} // anonymous
+
+void make_soup(GameOfLife &game, const SoupOptions &options, std::uint64_t seed)
+{
+    if (game.get_width() != options.width || game.get_height() != options.height)
+    {
+        game.resize(options.width, options.height);
+    }
+    game.clear();
+    game.set_rule(options.rule);
+    if (game.is_bounded() != options.bounded)
+    {
+        game.toggle_boundary();
+    }
+
+    // the cells come from the 53 high bits of the generator instead of a
+    // distribution, so the soup of a seed is the same with every library
+    std::mt19937_64 random(seed);
+    std::size_t size = std::min(options.soup_size, std::min(options.width, options.height));
+    int left = static_cast<int>((options.width - size) / 2);
+    int top = static_cast<int>((options.height - size) / 2);
+    for (std::size_t y = 0; y < size; ++y)
+    {
+        for (std::size_t x = 0; x < size; ++x)
+        {
+            if ((random() >> 11) * (1.0 / 9007199254740992.0) < options.density)
+            {
+                game.born({left + static_cast<int>(x), top + static_cast<int>(y)});
+            }
+        }
+    }
+}
+
+SoupResult run_soup(GameOfLife &game, const SoupOptions &options, std::uint64_t seed)
+{
+    make_soup(game, options, seed);
+    while (game.period() == 0 && game.generation() < options.max_generations)
+    {
+        game.next();
+    }
+
+    SoupResult result = {seed, game.generation(), game.population(), game.period(), Census{{}, 0}};
+    if (game.period() != 0)
+    {
+        // the repeated state appeared first a period earlier
+        result.lifespan -= game.period();
+    }
+    if (options.library)
+    {
+        result.census = game.census(*options.library);
+    }
+    return result;
+}
+
+void search_soups(const SoupOptions &options, std::uint64_t first_seed, std::uint64_t count,
+                  std::size_t threads,
+                  const std::function<void(const SoupResult &, std::size_t)> &report)
+{
+    if (threads == 0)
+    {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    threads = static_cast<std::size_t>(std::min<std::uint64_t>(threads, std::max<std::uint64_t>(count, 1)));
+
+    std::vector<SeedRange> ranges(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+        ranges[i].begin = first_seed + count * i / threads;
+        ranges[i].end = first_seed + count * (i + 1) / threads;
+    }
+
+    auto work = [&](std::size_t thread)
+    {
+        GameOfLife game(options.width, options.height);
+        std::uint64_t seed = 0;
+        while (true)
+        {
+            if (!take(ranges[thread], seed))
+            {
+                // the stolen seeds can be stolen again before they are taken
+                if (!steal(ranges, thread))
+                {
+                    break;
+                }
+                continue;
+            }
+            report(run_soup(game, options, seed), thread);
+        }
+    };
+
+    // the calling thread is the first worker
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < threads; ++i)
+    {
+        workers.emplace_back(work, i);
+    }
+    work(0);
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+} // gol
+
+} // nzs
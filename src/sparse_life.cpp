@@ -0,0 +1,395 @@
+#include "sparse_life.hpp"
+#include "bit_grid.hpp"
+#include "life_logic.hpp"
+#include "cpp_features.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+const std::size_t SparseLife::tile_size;
+
+namespace
+{
+
+using word_type = std::uint64_t;
+
+const std::int64_t tile_shift = 6;
+const std::int64_t tile_mask = SparseLife::tile_size - 1;
+const std::size_t last_row = SparseLife::tile_size - 1;
+const std::size_t last_bit = 63;
+
+const SparseLife::tile_type &empty_tile()
+{
+    static const SparseLife::tile_type tile = {{}};
+    return tile;
+}
+
+// floor division, so the negative cells go to the tile on their left
+inline SparseLife::TileKey tile_of(const Position64 &pos) NOEXCEPT
+{
+    return {pos.get_x() >> tile_shift, pos.get_y() >> tile_shift};
+}
+
+inline bool row_major_less(const SparseLife::TileKey &lhs, const SparseLife::TileKey &rhs) NOEXCEPT
+{
+    return lhs.y < rhs.y || (lhs.y == rhs.y && lhs.x < rhs.x);
+}
+
+// a tile and its neighbors, [dy][dx]
+using window_type = const SparseLife::tile_type *[3][3];
+
+inline const SparseLife::tile_type *find_tile(const SparseLife::tile_map &tiles,
+                                              std::int64_t x, std::int64_t y)
+{
+    auto it = tiles.find({x, y});
+    return (it == tiles.end()) ? &empty_tile() : &it->second;
+}
+
+// next state of one word of cells under a rule whose masks are known at run time
+struct MaskCells
+{
+    unsigned birth;
+    unsigned survival;
+
+    inline word_type operator()(word_type up_w, word_type up, word_type up_e,
+                                word_type w, word_type mid, word_type e,
+                                word_type down_w, word_type down, word_type down_e) const
+    {
+        word_type ones, twos, fours, eights;
+        details::count_neighbors(up_w, up, up_e, w, e, down_w, down, down_e,
+                                 ones, twos, fours, eights);
+
+        word_type born = 0;
+        word_type survive = 0;
+        for (unsigned count = 0; count <= 8; ++count)
+        {
+            if (((birth | survival) >> count) & 1)
+            {
+                word_type match = ((count & 1) ? ones : ~ones) & ((count & 2) ? twos : ~twos) &
+                                  ((count & 4) ? fours : ~fours) & ((count & 8) ? eights : ~eights);
+                born |= ((birth >> count) & 1) ? match : 0;
+                survive |= ((survival >> count) & 1) ? match : 0;
+            }
+        }
+        return (born & ~mid) | (survive & mid);
+    }
+};
+
+// step the middle tile of the window into next and count its alive cells,
+// returns the OR of its rows
+template<class Cells>
+word_type step_window(const Cells &cells, const window_type &around,
+                      SparseLife::tile_type &next, std::size_t &alive)
+{
+    // word of the tile row y (-1 and tile_size are the rows of the north/south tiles)
+    auto word = [&](int dx, int y) -> word_type
+    {
+        int dy = (y < 0) ? 0 : (y > static_cast<int>(last_row) ? 2 : 1);
+        return (*around[dy][dx])[(y + SparseLife::tile_size) & tile_mask];
+    };
+
+    word_type any = 0;
+    for (int y = 0; y < static_cast<int>(SparseLife::tile_size); ++y)
+    {
+        word_type c[3];
+        word_type w[3];
+        word_type e[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            c[i] = word(1, y + i - 1);
+            w[i] = (c[i] << 1) | (word(0, y + i - 1) >> last_bit);
+            e[i] = (c[i] >> 1) | (word(2, y + i - 1) << last_bit);
+        }
+
+        word_type row = cells(w[0], c[0], e[0], w[1], c[1], e[1], w[2], c[2], e[2]);
+        next[y] = row;
+        any |= row;
+        alive += details::popcount(row);
+    }
+    return any;
+}
+
+using step_function = word_type (*)(const Rule &rule, const window_type &around,
+                                    SparseLife::tile_type &next, std::size_t &alive);
+
+template<unsigned Birth, unsigned Survival>
+word_type step_rule(const Rule &, const window_type &around,
+                    SparseLife::tile_type &next, std::size_t &alive)
+{
+    return step_window(details::RuleCells<Birth, Survival>(), around, next, alive);
+}
+
+word_type step_masks(const Rule &rule, const window_type &around,
+                     SparseLife::tile_type &next, std::size_t &alive)
+{
+    return step_window(MaskCells{rule.birth(), rule.survival()}, around, next, alive);
+}
+
+template<unsigned Birth, unsigned Survival>
+struct TileStep
+{
+    static step_function get()
+    {
+        return &step_rule<Birth, Survival>;
+    }
+};
+
+} // anonymous
+
+SparseLife::SparseLife() :
+    generation_(0),
+    population_(0)
+{
+}
+
+bool SparseLife::supports(const Rule &rule) NOEXCEPT
+{
+    return (rule.birth() & 1) == 0;
+}
+
+void SparseLife::kill(const Position64 &pos)
+{
+    if (is_alive(pos))
+    {
+        set_cell(pos, false);
+        --population_;
+    }
+}
+
+void SparseLife::born(const Position64 &pos)
+{
+    if (!is_alive(pos))
+    {
+        set_cell(pos, true);
+        ++population_;
+    }
+}
+
+void SparseLife::flip(const Position64 &pos)
+{
+    if (is_alive(pos))
+    {
+        kill(pos);
+    }
+    else
+    {
+        born(pos);
+    }
+}
+
+void SparseLife::next(std::size_t iteration)
+{
+    for (std::size_t i = 0; i < iteration; i++)
+    {
+        // every tile can change, and so can its neighbors if it has alive cells on that edge
+        candidates_.clear();
+        for (const auto &tile : tiles_)
+        {
+            const TileKey &key = tile.first;
+            const tile_type &rows = tile.second;
+
+            word_type west = 0;
+            word_type east = 0;
+            for (auto row : rows)
+            {
+                west |= row & 1;
+                east |= row >> last_bit;
+            }
+            bool north = rows[0] != 0;
+            bool south = rows[last_row] != 0;
+
+            candidates_.push_back(key);
+            if (north)
+            {
+                candidates_.push_back({key.x, key.y - 1});
+            }
+            if (south)
+            {
+                candidates_.push_back({key.x, key.y + 1});
+            }
+            if (west)
+            {
+                candidates_.push_back({key.x - 1, key.y});
+            }
+            if (east)
+            {
+                candidates_.push_back({key.x + 1, key.y});
+            }
+            if (rows[0] & 1)
+            {
+                candidates_.push_back({key.x - 1, key.y - 1});
+            }
+            if (rows[0] >> last_bit)
+            {
+                candidates_.push_back({key.x + 1, key.y - 1});
+            }
+            if (rows[last_row] & 1)
+            {
+                candidates_.push_back({key.x - 1, key.y + 1});
+            }
+            if (rows[last_row] >> last_bit)
+            {
+                candidates_.push_back({key.x + 1, key.y + 1});
+            }
+        }
+        std::sort(candidates_.begin(), candidates_.end(), &row_major_less);
+        candidates_.erase(std::unique(candidates_.begin(), candidates_.end()), candidates_.end());
+
+        step_function step = details::rule_kernel<TileStep>(rule_.birth(), rule_.survival());
+        if (!step)
+        {
+            step = &step_masks;
+        }
+
+        next_tiles_.clear();
+        population_ = 0;
+        // the candidates are in row-major order, so the window slides to the east
+        // tile with three lookups instead of nine
+        window_type around;
+        const TileKey *previous = nullptr;
+        for (const auto &key : candidates_)
+        {
+            int first_column = 0;
+            if (previous && previous->y == key.y && previous->x + 1 == key.x)
+            {
+                for (int dy = 0; dy < 3; ++dy)
+                {
+                    around[dy][0] = around[dy][1];
+                    around[dy][1] = around[dy][2];
+                }
+                first_column = 2;
+            }
+            for (int dy = 0; dy < 3; ++dy)
+            {
+                for (int dx = first_column; dx < 3; ++dx)
+                {
+                    around[dy][dx] = find_tile(tiles_, key.x + dx - 1, key.y + dy - 1);
+                }
+            }
+            previous = &key;
+
+            tile_type rows;
+            std::size_t alive = 0;
+            if (step(rule_, around, rows, alive) != 0)
+            {
+                next_tiles_.insert(std::make_pair(key, rows));
+                population_ += alive;
+            }
+        }
+        tiles_.swap(next_tiles_);
+
+        ++generation_;
+    }
+}
+
+void SparseLife::clear()
+{
+    tiles_.clear();
+    next_tiles_.clear();
+    generation_ = 0;
+    population_ = 0;
+}
+
+bool SparseLife::is_alive(const Position64 &pos) const
+{
+    auto it = tiles_.find(tile_of(pos));
+    if (it == tiles_.end())
+    {
+        return false;
+    }
+    return (it->second[pos.get_y() & tile_mask] >> (pos.get_x() & tile_mask)) & 1;
+}
+
+void SparseLife::set_cells(const BitGrid &grid, const Position64 &offset)
+{
+    clear();
+    for (std::size_t y = 0; y < grid.get_height(); ++y)
+    {
+        const BitGrid::word_type *row = grid.row(y);
+        for (std::size_t i = 0; i < grid.words_per_row(); ++i)
+        {
+            word_type word = row[i];
+            if (i + 1 == grid.words_per_row())
+            {
+                word &= grid.tail_mask();
+            }
+            while (word != 0)
+            {
+                std::size_t bit = details::lowest_bit(word);
+                word &= word - 1;
+                set_cell({offset.get_x() + static_cast<std::int64_t>(i * BitGrid::word_bits + bit),
+                          offset.get_y() + static_cast<std::int64_t>(y)}, true);
+                ++population_;
+            }
+        }
+    }
+}
+
+void SparseLife::get_cells(std::vector<Position64> &cells) const
+{
+    for (const auto &tile : tiles_)
+    {
+        std::int64_t left = tile.first.x * static_cast<std::int64_t>(tile_size);
+        std::int64_t top = tile.first.y * static_cast<std::int64_t>(tile_size);
+        for (std::size_t y = 0; y < tile_size; ++y)
+        {
+            word_type word = tile.second[y];
+            while (word != 0)
+            {
+                std::size_t bit = details::lowest_bit(word);
+                word &= word - 1;
+                cells.push_back({left + static_cast<std::int64_t>(bit),
+                                 top + static_cast<std::int64_t>(y)});
+            }
+        }
+    }
+}
+
+void SparseLife::set_rule(const Rule &rule)
+{
+    if (!supports(rule))
+    {
+        throw std::invalid_argument("SparseLife: the B0 rules are not supported");
+    }
+    rule_ = rule;
+}
+
+void SparseLife::set_cell(const Position64 &pos, bool alive)
+{
+    TileKey key = tile_of(pos);
+    word_type mask = word_type(1) << (pos.get_x() & tile_mask);
+    if (alive)
+    {
+        auto it = tiles_.insert(std::make_pair(key, empty_tile())).first;
+        it->second[pos.get_y() & tile_mask] |= mask;
+        return;
+    }
+
+    auto it = tiles_.find(key);
+    if (it == tiles_.end())
+    {
+        return;
+    }
+    tile_type &rows = it->second;
+    rows[pos.get_y() & tile_mask] &= ~mask;
+
+    // free the tile if it became empty
+    for (auto row : rows)
+    {
+        if (row != 0)
+        {
+            return;
+        }
+    }
+    tiles_.erase(it);
+}
+
+} // gol
+
+} // nzs
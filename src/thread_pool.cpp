@@ -0,0 +1,122 @@
+#include "thread_pool.hpp"
+#include "trace.hpp"
+#include "cpp_features.hpp"
+
+namespace nzs
+{
+
+namespace gol
+{
+
+ThreadPool::ThreadPool(std::size_t threads) :
+    invoke_(nullptr),
+    task_(nullptr),
+    count_(0),
+    next_task_(0),
+    busy_(0),
+    job_(0),
+    stop_(false)
+{
+    if (threads == 0)
+    {
+        threads = std::thread::hardware_concurrency();
+    }
+
+    for (std::size_t i = 1; i < threads; ++i)
+    {
+        workers_.emplace_back(&ThreadPool::worker, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_.notify_all();
+
+    for (auto &worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::run(std::size_t count, invoker invoke, void *task)
+{
+    if (workers_.empty() || count == 1)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            invoke(task, i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        invoke_ = invoke;
+        task_ = task;
+        count_ = count;
+        next_task_ = 0;
+        busy_ = workers_.size();
+        ++job_;
+    }
+    start_.notify_all();
+
+    work();
+
+    // every worker takes part in every job, so none of them
+    // can see this task after returning
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]()
+    {
+        return busy_ == 0;
+    });
+    task_ = nullptr;
+}
+
+void ThreadPool::worker()
+{
+    set_thread_name("pool worker");
+    std::size_t seen_job = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        start_.wait(lock, [&]()
+        {
+            return stop_ || job_ != seen_job;
+        });
+        if (stop_)
+        {
+            return;
+        }
+        seen_job = job_;
+
+        lock.unlock();
+        work();
+        lock.lock();
+
+        if (--busy_ == 0)
+        {
+            done_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::work()
+{
+    while (true)
+    {
+        std::size_t i = next_task_.fetch_add(1);
+        if (i >= count_)
+        {
+            return;
+        }
+        invoke_(task_, i);
+    }
+}
+
+} // gol
+
+} // nzs
@@ -0,0 +1,230 @@
+#include "timing.hpp"
+#include "bit_grid.hpp"
+#include "cpp_features.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace
+{
+
+std::size_t bucket_index(std::uint64_t nanoseconds) NOEXCEPT
+{
+    if (nanoseconds < 4)
+    {
+        return static_cast<std::size_t>(nanoseconds);
+    }
+    // the highest bit selects the power of two, the next two bits the quarter
+    std::size_t high = details::highest_bit(nanoseconds);
+    std::size_t index = 4 * (high - 1) + ((nanoseconds >> (high - 2)) & 3);
+    return index < timer_buckets ? index : timer_buckets - 1;
+}
+
+double bucket_low(std::size_t index) NOEXCEPT
+{
+    if (index < 4)
+    {
+        return static_cast<double>(index);
+    }
+    return std::ldexp(static_cast<double>(4 + index % 4), static_cast<int>(index / 4 - 1));
+}
+
+double bucket_width(std::size_t index) NOEXCEPT
+{
+    return index < 4 ? 1.0 : std::ldexp(1.0, static_cast<int>(index / 4 - 1));
+}
+
+// the middle of the bucket of the q quantile
+double quantile(const TimerCounts &counts, double q) NOEXCEPT
+{
+    if (counts.count == 0)
+    {
+        return 0.0;
+    }
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(q * counts.count));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < timer_buckets; ++i)
+    {
+        seen += counts.buckets[i];
+        if (seen >= rank && counts.buckets[i] != 0)
+        {
+            double middle = i < 4 ? bucket_low(i) : bucket_low(i) + bucket_width(i) / 2;
+            return std::min(middle, static_cast<double>(counts.max));
+        }
+    }
+    return static_cast<double>(counts.max);
+}
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Histogram> > timers;
+};
+
+Registry &get_registry()
+{
+    static Registry registry;
+    return registry;
+}
+
+std::string json_string(const std::string &text)
+{
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+} // anonymous
+
+Histogram::Histogram(const std::string &name) :
+    name_(name),
+    count_(0),
+    total_(0),
+    max_(0)
+{
+    for (auto &bucket : buckets_)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::record(std::uint64_t nanoseconds) NOEXCEPT
+{
+    buckets_[bucket_index(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(nanoseconds, std::memory_order_relaxed);
+    std::uint64_t max = max_.load(std::memory_order_relaxed);
+    while (nanoseconds > max &&
+            !max_.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+}
+
+TimerCounts Histogram::counts() const NOEXCEPT
+{
+    TimerCounts counts;
+    counts.count = count_.load(std::memory_order_relaxed);
+    counts.total = total_.load(std::memory_order_relaxed);
+    counts.max = max_.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < timer_buckets; ++i)
+    {
+        counts.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+TimerCounts difference(const TimerCounts &now, const TimerCounts &before) NOEXCEPT
+{
+    TimerCounts counts;
+    counts.count = now.count - before.count;
+    counts.total = now.total - before.total;
+    counts.max = 0;
+    for (std::size_t i = 0; i < timer_buckets; ++i)
+    {
+        counts.buckets[i] = now.buckets[i] - before.buckets[i];
+        if (counts.buckets[i] != 0)
+        {
+            counts.max = static_cast<std::uint64_t>(bucket_low(i) + bucket_width(i)) - 1;
+        }
+    }
+    if (counts.max > now.max)
+    {
+        counts.max = now.max;
+    }
+    return counts;
+}
+
+TimerSummary summarize(const std::string &name, const TimerCounts &counts)
+{
+    TimerSummary summary;
+    summary.name = name;
+    summary.count = counts.count;
+    summary.mean = counts.count == 0 ? 0.0 : static_cast<double>(counts.total) / counts.count;
+    summary.p50 = quantile(counts, 0.50);
+    summary.p90 = quantile(counts, 0.90);
+    summary.p99 = quantile(counts, 0.99);
+    summary.max = static_cast<double>(counts.max);
+    return summary;
+}
+
+Histogram &get_timer(const std::string &name)
+{
+    Registry &registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const auto &timer : registry.timers)
+    {
+        if (timer->name() == name)
+        {
+            return *timer;
+        }
+    }
+    registry.timers.emplace_back(new Histogram(name));
+    return *registry.timers.back();
+}
+
+std::vector<const Histogram *> all_timers()
+{
+    Registry &registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::vector<const Histogram *> timers;
+    for (const auto &timer : registry.timers)
+    {
+        timers.push_back(timer.get());
+    }
+    return timers;
+}
+
+void write_timers(std::ostream &out)
+{
+    auto timers = all_timers();
+    out << "{\n";
+    out << "  \"time_unit\": \"us\",\n";
+    out << "  \"timers\": [\n";
+    for (std::size_t i = 0; i < timers.size(); ++i)
+    {
+        TimerSummary summary = summarize(timers[i]->name(), timers[i]->counts());
+        out << "    {\n";
+        out << "      \"name\": " << json_string(summary.name) << ",\n";
+        out << "      \"count\": " << summary.count << ",\n";
+        out << "      \"total\": " << summary.mean * summary.count / 1e3 << ",\n";
+        out << "      \"mean\": " << summary.mean / 1e3 << ",\n";
+        out << "      \"p50\": " << summary.p50 / 1e3 << ",\n";
+        out << "      \"p90\": " << summary.p90 / 1e3 << ",\n";
+        out << "      \"p99\": " << summary.p99 / 1e3 << ",\n";
+        out << "      \"max\": " << summary.max / 1e3 << "\n";
+        out << "    }" << (i + 1 < timers.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}" << std::endl;
+}
+
+bool write_timers(const std::string &file_path)
+{
+    std::ofstream file(file_path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    write_timers(file);
+    return static_cast<bool>(file);
+}
+
+} // gol
+
+} // nzs
@@ -0,0 +1,212 @@
+#include "trace.hpp"
+#include "log.hpp"
+#include "cpp_features.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace nzs
+{
+
+namespace gol
+{
+
+namespace
+{
+
+struct ThreadBuffer
+{
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+    std::string name;
+    std::size_t id;
+    std::size_t dropped;
+};
+
+// the buffers outlive their threads, so the events of a finished thread are written
+// too; a buffer is made at the first event of a thread, so only the threads which
+// ran while tracing have one, and write_trace() leaves them empty
+struct Registry
+{
+    Registry() :
+        next_id(1)
+    {
+    }
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer> > buffers;
+    std::size_t next_id;
+};
+
+Registry &get_registry()
+{
+    static Registry registry;
+    return registry;
+}
+
+// the state of the calling thread, plain pointers so nothing is made for the
+// threads which never record an event
+THREAD_LOCAL const char *thread_name = nullptr;
+THREAD_LOCAL ThreadBuffer *thread_events = nullptr;
+
+ThreadBuffer &thread_buffer()
+{
+    if (!thread_events)
+    {
+        std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+        buffer->dropped = 0;
+        Registry &registry = get_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        buffer->id = registry.next_id++;
+        buffer->name = thread_name ? thread_name : "thread " + std::to_string(buffer->id);
+        thread_events = buffer.get();
+        registry.buffers.push_back(std::move(buffer));
+    }
+    return *thread_events;
+}
+
+std::string json_string(const std::string &text)
+{
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+// nanoseconds as microseconds without rounding
+void write_microseconds(std::ostream &out, std::uint64_t nanoseconds)
+{
+    out << nanoseconds / 1000 << '.' << std::setw(3) << std::setfill('0') << nanoseconds % 1000
+        << std::setfill(' ');
+}
+
+} // anonymous
+
+std::uint64_t trace_clock() NOEXCEPT
+{
+    using clock_type = std::chrono::steady_clock;
+    static const clock_type::time_point start = clock_type::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count();
+}
+
+void record_event(const TraceEvent &event)
+{
+    ThreadBuffer &buffer = thread_buffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.events.size() < max_trace_events)
+    {
+        buffer.events.push_back(event);
+    }
+    else
+    {
+        ++buffer.dropped;
+    }
+}
+
+void set_thread_name(const char *name)
+{
+    thread_name = name;
+    if (thread_events)
+    {
+        std::lock_guard<std::mutex> lock(thread_events->mutex);
+        thread_events->name = name;
+    }
+}
+
+void write_trace(std::ostream &out)
+{
+    // the buffers are never freed, so the pointers stay valid without the lock
+    std::vector<ThreadBuffer *> buffers;
+    {
+        Registry &registry = get_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (const auto &buffer : registry.buffers)
+        {
+            buffers.push_back(buffer.get());
+        }
+    }
+
+    out << "{\n";
+    out << "  \"displayTimeUnit\": \"ms\",\n";
+    out << "  \"traceEvents\": [\n";
+    bool first = true;
+    std::size_t dropped = 0;
+    for (auto buffer : buffers)
+    {
+        // the events are moved out, so the thread does not wait for the file
+        std::vector<TraceEvent> events;
+        std::string name;
+        {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            events.swap(buffer->events);
+            name = buffer->name;
+            dropped += buffer->dropped;
+            buffer->dropped = 0;
+        }
+
+        out << (first ? "" : ",\n");
+        first = false;
+        out << "    {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->id
+            << ", \"args\": {\"name\": " << json_string(name) << "}}";
+        for (const auto &event : events)
+        {
+            out << ",\n    {\"name\": " << json_string(event.name)
+                << ", \"cat\": " << json_string(event.category)
+                << ", \"ph\": \"X\", \"ts\": ";
+            write_microseconds(out, event.begin);
+            out << ", \"dur\": ";
+            write_microseconds(out, event.duration);
+            out << ", \"pid\": 1, \"tid\": " << buffer->id;
+            if (event.arg_name)
+            {
+                out << ", \"args\": {" << json_string(event.arg_name) << ": " << event.arg << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n  ]\n";
+    out << "}" << std::endl;
+
+    if (dropped != 0)
+    {
+        Log::warning(dropped, "trace events dropped, the buffers of the threads were full");
+    }
+}
+
+bool write_trace(const std::string &file_path)
+{
+    std::ofstream file(file_path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    write_trace(file);
+    return static_cast<bool>(file);
+}
+
+void clear_trace()
+{
+    Registry &registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const auto &buffer : registry.buffers)
+    {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        // the memory of the events is freed, a buffer of a finished thread stays empty
+        std::vector<TraceEvent>().swap(buffer->events);
+        buffer->dropped = 0;
+    }
+}
+
+} // gol
+
+} // nzs
@@ -0,0 +1,139 @@
+#include "game_of_life.hpp"
+#include "life_kernel.hpp"
+#include "rule.hpp"
+
+#include <cstdlib>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+
+// the bitwise engine with every instruction set against the cell by cell
+// reference engine: random boards of odd sizes on both boundaries, stepped
+// with several thread counts, compared after every generation
+
+using nzs::gol::GameOfLife;
+using nzs::gol::Engine;
+using nzs::gol::Rule;
+namespace details = nzs::gol::details;
+
+std::size_t FAILURES = 0;
+
+void fill(GameOfLife &game, std::mt19937_64 &random, double density)
+{
+    std::bernoulli_distribution alive(density);
+    for (std::size_t y = 0; y < game.get_height(); ++y)
+    {
+        for (std::size_t x = 0; x < game.get_width(); ++x)
+        {
+            if (alive(random))
+            {
+                game.born({static_cast<int>(x), static_cast<int>(y)});
+            }
+        }
+    }
+}
+
+// the first different cell, or false if the boards are the same
+bool differs(const GameOfLife &game, const GameOfLife &reference, std::size_t &x, std::size_t &y)
+{
+    for (y = 0; y < reference.get_height(); ++y)
+    {
+        for (x = 0; x < reference.get_width(); ++x)
+        {
+            if (game.grid().get(x, y) != reference.grid().get(x, y))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void check(details::Simd simd, const std::string &rule, bool bounded, std::size_t width,
+           std::size_t height, std::size_t threads, std::size_t generations, std::uint64_t seed)
+{
+    GameOfLife game(width, height, Engine::bitwise);
+    GameOfLife reference(width, height, Engine::reference);
+    game.set_threads(threads);
+    for (GameOfLife *board : {&game, &reference})
+    {
+        board->set_rule(Rule::parse(rule));
+        if (bounded)
+        {
+            board->toggle_boundary();
+        }
+    }
+    std::mt19937_64 random(seed);
+    fill(game, random, 0.35);
+    random.seed(seed);
+    fill(reference, random, 0.35);
+
+    for (std::size_t generation = 1; generation <= generations; ++generation)
+    {
+        game.next();
+        reference.next();
+        std::size_t x = 0;
+        std::size_t y = 0;
+        if (game.population() != reference.population() || differs(game, reference, x, y))
+        {
+            std::cout << "FAILED " << details::simd_name(simd) << " rule: " << rule
+                      << (bounded ? " bounded " : " torus ") << width << "x" << height
+                      << " threads: " << threads << " seed: " << seed
+                      << " generation: " << generation << " cell: " << x << "," << y
+                      << " population: " << game.population() << " != " << reference.population()
+                      << std::endl;
+            ++FAILURES;
+            return;
+        }
+    }
+}
+
+int main()
+{
+    const details::Simd simds[] = {details::Simd::scalar, details::Simd::sse2, details::Simd::avx2};
+    // the compiled kernels and a rule of the lookup table
+    const char *rules[] = {"B3/S23", "B36/S23", "B2/S"};
+    // narrower than a word, exactly words, and words with a remainder
+    const std::size_t widths[] = {13, 64, 100, 197, 320};
+    const std::size_t generations = 300;
+    // the smallest board which is split between the threads (16 words x 280 rows)
+    const std::size_t threads[] = {2, 4};
+    const std::size_t parallel_generations = 60;
+
+    std::size_t cases = 0;
+    std::size_t stepped = 0;
+    for (auto simd : simds)
+    {
+        details::set_simd(simd);
+        if (details::simd() != simd)
+        {
+            std::cout << "skipped " << details::simd_name(simd) << ", not supported" << std::endl;
+            continue;
+        }
+        std::uint64_t seed = 1;
+        for (const char *rule : rules)
+        {
+            for (bool bounded : {false, true})
+            {
+                for (std::size_t width : widths)
+                {
+                    check(simd, rule, bounded, width, width % 2 == 0 ? 150 : 67, 1, generations, seed++);
+                    ++cases;
+                    stepped += generations;
+                }
+                for (std::size_t thread_count : threads)
+                {
+                    check(simd, rule, bounded, 1000, 280, thread_count, parallel_generations, seed++);
+                    ++cases;
+                    stepped += parallel_generations;
+                }
+            }
+        }
+        std::cout << details::simd_name(simd) << " done" << std::endl;
+    }
+    details::set_simd(details::simd_support());
+
+    std::cout << cases << " cases, " << stepped << " generations, " << FAILURES << " failed" << std::endl;
+    return FAILURES == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,404 @@
+#include "game_of_life.hpp"
+#include "sparse_life.hpp"
+#include "life_kernel.hpp"
+#include "brush_tool.hpp"
+#include "pattern_io.hpp"
+#include "log.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <cctype>
+
+// throughput of the simulation core, the results are written in the JSON
+// format of Google Benchmark so the usual comparing tools can read them
+
+double MIN_TIME = 0.5;
+std::size_t MAX_SIZE = 16384;
+std::size_t THREADS = 1;
+std::string FILTER;
+std::string OUTPUT;
+std::string BRUSHS = "./brushs.txt";
+
+using clock_type = std::chrono::steady_clock;
+
+struct Result
+{
+    std::string name;
+    std::size_t iterations;
+    // seconds per iteration
+    double time;
+    double cpu_time;
+    double cells_per_second;
+    double generations_per_second;
+};
+
+template<class T>
+bool fetch_value(const std::string &text, T &value)
+{
+    std::istringstream convert(text);
+    T tmp;
+    if (!(convert >> tmp) || !convert.eof())
+    {
+        Log::warning("Invalid parameter value:", text);
+        return false;
+    }
+    value = tmp;
+    return true;
+}
+
+void parseCLA(int argc, const char *argv[])
+{
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    for (std::size_t i = 0; i < args.size(); ++i)
+    {
+        if (args[i] == "--help")
+        {
+            std::cout << "USAGE: " + std::string(argv[0])
+                      << " [--filter ARG] [--min-time ARG] [--max-size ARG] [-t|--threads ARG]"
+                      << " [-b|--brushs FILE] [-o|--output FILE] [--help]" << std::endl;
+
+            std::cout << std::endl << "Option Descriptions" << std::endl << std::endl;
+
+            std::cout << std::left;
+            std::cout << std::setw(15) << "\t--filter"          << "\t\t" << "Run only the benchmarks whose name contains ARG." << std::endl;
+            std::cout << std::setw(15) << "\t--min-time"        << "\t\t" << "Run every benchmark for at least ARG seconds." << std::endl;
+            std::cout << std::setw(15) << "\t--max-size"        << "\t\t" << "Skip the grids wider than ARG cells." << std::endl;
+            std::cout << std::setw(15) << "\t-t [ --threads ]"  << "\t" << "Set the number of stepping threads (0 = one per core)." << std::endl;
+            std::cout << std::setw(15) << "\t-b [ --brushs ]"   << "\t\t" << "Benchmark the patterns of this brush file." << std::endl;
+            std::cout << std::setw(15) << "\t-o [ --output ]"   << "\t\t" << "Write the JSON to a file instead of the standard output." << std::endl;
+            std::cout << std::setw(15) << "\t--help"            << "\t\t" << "Print this message and exit." << std::endl;
+            std::exit(EXIT_SUCCESS);
+        }
+        // && ++i < args.size() = next argument is exist?
+        else if (args[i] == "--filter" && ++i < args.size())
+        {
+            FILTER = args[i];
+        }
+        else if (args[i] == "--min-time" && ++i < args.size())
+        {
+            fetch_value(args[i], MIN_TIME);
+        }
+        else if (args[i] == "--max-size" && ++i < args.size())
+        {
+            fetch_value(args[i], MAX_SIZE);
+        }
+        else if ((args[i] == "-t" || args[i] == "--threads") && ++i < args.size())
+        {
+            fetch_value(args[i], THREADS);
+        }
+        else if ((args[i] == "-b" || args[i] == "--brushs") && ++i < args.size())
+        {
+            BRUSHS = args[i];
+        }
+        else if ((args[i] == "-o" || args[i] == "--output") && ++i < args.size())
+        {
+            OUTPUT = args[i];
+        }
+        else
+        {
+            Log::warning("Invalid parameter:", args[i]);
+        }
+    }
+}
+
+void fill_random(nzs::gol::GameOfLife &game, double density)
+{
+    if (density <= 0.0)
+    {
+        return;
+    }
+
+    std::mt19937_64 random(1);
+    std::bernoulli_distribution alive(density);
+    for (std::size_t y = 0; y < game.get_height(); ++y)
+    {
+        for (std::size_t x = 0; x < game.get_width(); ++x)
+        {
+            if (alive(random))
+            {
+                game.born({static_cast<int>(x), static_cast<int>(y)});
+            }
+        }
+    }
+}
+
+// call step (which does iterations of work) with growing iterations until it takes MIN_TIME,
+// reset (if any) puts the case back to its first state before every timed run
+Result measure(const std::string &name, std::size_t cells,
+               const std::function<void(std::size_t)> &step,
+               const std::function<void()> &reset = nullptr)
+{
+    std::size_t iterations = 1;
+    double seconds = 0.0;
+    double cpu_seconds = 0.0;
+    while (true)
+    {
+        if (reset)
+        {
+            reset();
+        }
+        auto start = clock_type::now();
+        std::clock_t cpu_start = std::clock();
+        step(iterations);
+        seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+        cpu_seconds = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+        if (seconds >= MIN_TIME || iterations >= (std::size_t(1) << 30))
+        {
+            break;
+        }
+
+        // aim a bit above the minimum time like Google Benchmark does
+        double scale = seconds > 0.0 ? 1.4 * MIN_TIME / seconds : 10.0;
+        iterations = static_cast<std::size_t>(iterations * std::min(std::max(scale, 1.1), 10.0)) + 1;
+    }
+
+    double time = seconds / iterations;
+    Result result = {name, iterations, time, cpu_seconds / iterations, cells / time, 1.0 / time};
+    Log::verbose(name, "iterations:", iterations, "time:", time * 1e9, "ns");
+    return result;
+}
+
+// the brush name in lower case with '_' between the words ("gosper_glider_gun"),
+// the id if the brush has no name
+std::string pattern_name(const std::string &brush_name, std::size_t id)
+{
+    std::string name;
+    bool separate = false;
+    for (char c : brush_name)
+    {
+        if (std::isalnum(static_cast<unsigned char>(c)))
+        {
+            if (separate && !name.empty())
+            {
+                name += '_';
+            }
+            name += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            separate = false;
+        }
+        else
+        {
+            separate = true;
+        }
+    }
+    return name.empty() ? std::to_string(id) : name;
+}
+
+bool selected(const std::string &name)
+{
+    return FILTER.empty() || name.find(FILTER) != std::string::npos;
+}
+
+std::string json_string(const std::string &text)
+{
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+void write_json(std::ostream &out, const std::vector<Result> &results)
+{
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    out << "{\n";
+    out << "  \"context\": {\n";
+    out << "    \"date\": " << json_string(date) << ",\n";
+    out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "    \"simd\": " << json_string(nzs::gol::details::simd_name(nzs::gol::details::simd())) << ",\n";
+    out << "    \"threads\": " << THREADS << ",\n";
+#ifdef NDEBUG
+    out << "    \"library_build_type\": \"release\"\n";
+#else
+    out << "    \"library_build_type\": \"debug\"\n";
+#endif
+    out << "  },\n";
+    out << "  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const Result &result = results[i];
+        out << "    {\n";
+        out << "      \"name\": " << json_string(result.name) << ",\n";
+        out << "      \"run_type\": \"iteration\",\n";
+        out << "      \"iterations\": " << result.iterations << ",\n";
+        out << "      \"real_time\": " << result.time * 1e9 << ",\n";
+        out << "      \"cpu_time\": " << result.cpu_time * 1e9 << ",\n";
+        out << "      \"time_unit\": \"ns\",\n";
+        out << "      \"cells_per_second\": " << result.cells_per_second << ",\n";
+        out << "      \"generations_per_second\": " << result.generations_per_second << "\n";
+        out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}" << std::endl;
+}
+
+int main(int argc, char const *argv[])
+{
+    Log::init(argc, argv);
+    parseCLA(argc, argv);
+
+    using nzs::gol::GameOfLife;
+    using nzs::gol::Engine;
+
+    std::vector<Result> results;
+    const std::size_t sizes[] = {64, 256, 1024, 4096, 16384};
+    const double densities[] = {0.0, 0.05, 0.5};
+
+    // next() of the engines on random grids
+    for (auto engine : {Engine::bitwise, Engine::reference})
+    {
+        for (auto size : sizes)
+        {
+            // the reference engine would run for minutes on the large grids
+            if (size > MAX_SIZE || (engine == Engine::reference && size > 1024))
+            {
+                continue;
+            }
+
+            for (auto density : densities)
+            {
+                for (bool bounded : {false, true})
+                {
+                    std::ostringstream name;
+                    name << "next/" << (engine == Engine::bitwise ? "bitwise" : "reference")
+                         << "/" << (bounded ? "bounded" : "torus") << "/"
+                         << size << "x" << size << "/density:" << density;
+                    if (!selected(name.str()))
+                    {
+                        continue;
+                    }
+
+                    GameOfLife game(size, size, engine);
+                    game.set_threads(THREADS);
+                    if (bounded)
+                    {
+                        game.toggle_boundary();
+                    }
+                    fill_random(game, density);
+                    // every timed run starts from the random board, so the density is the named one
+                    const nzs::gol::BitGrid start = game.grid();
+                    results.push_back(measure(name.str(), size * size, [&](std::size_t iterations)
+                    {
+                        game.next(iterations);
+                    }, [&]()
+                    {
+                        game.restore(start, 0);
+                    }));
+                }
+            }
+        }
+    }
+
+    // next() of the sparse engine on a random square of the unbounded plane
+    for (auto size : sizes)
+    {
+        if (size > MAX_SIZE)
+        {
+            continue;
+        }
+
+        for (auto density : densities)
+        {
+            std::ostringstream name;
+            name << "next/sparse/" << size << "x" << size << "/density:" << density;
+            if (!selected(name.str()))
+            {
+                continue;
+            }
+
+            GameOfLife game(size, size);
+            fill_random(game, density);
+            nzs::gol::SparseLife life;
+            results.push_back(measure(name.str(), size * size, [&](std::size_t iterations)
+            {
+                life.next(iterations);
+            }, [&]()
+            {
+                life.set_cells(game.grid(), {0, 0});
+            }));
+        }
+    }
+
+    // resize() of a half full grid to the double and back
+    for (auto size : sizes)
+    {
+        std::ostringstream name;
+        name << "resize/" << size << "x" << size;
+        if (size * 2 > MAX_SIZE || !selected(name.str()))
+        {
+            continue;
+        }
+
+        GameOfLife game(size, size);
+        fill_random(game, 0.5);
+        results.push_back(measure(name.str(), size * size, [&](std::size_t iterations)
+        {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                game.resize(size * 2, size * 2);
+                game.resize(size, size);
+            }
+        }));
+    }
+
+    // the brushes in the middle of a 1024x1024 torus
+    nzs::gol::BrushTool brushs;
+    nzs::gol::BrushTool::load_from_file(BRUSHS, brushs);
+    const std::size_t pattern_size = 1024;
+    for (std::size_t id = 1; id < brushs.size() && pattern_size <= MAX_SIZE; ++id)
+    {
+        brushs.use(id);
+        std::ostringstream name;
+        name << "pattern/" << pattern_name(brushs.name(), id) << "/" << pattern_size << "x" << pattern_size;
+        if (!selected(name.str()))
+        {
+            continue;
+        }
+
+        GameOfLife game(pattern_size, pattern_size);
+        game.set_threads(THREADS);
+        nzs::gol::place(game, brushs.get(), {static_cast<int>(pattern_size / 2),
+                                             static_cast<int>(pattern_size / 2)});
+        const nzs::gol::BitGrid start = game.grid();
+        results.push_back(measure(name.str(), pattern_size * pattern_size, [&](std::size_t iterations)
+        {
+            game.next(iterations);
+        }, [&]()
+        {
+            game.restore(start, 0);
+        }));
+    }
+
+    if (OUTPUT.empty())
+    {
+        write_json(std::cout, results);
+        return EXIT_SUCCESS;
+    }
+
+    std::ofstream file(OUTPUT);
+    if (!file.is_open())
+    {
+        Log::error("cannot open file:", OUTPUT);
+        return EXIT_FAILURE;
+    }
+    write_json(file, results);
+    return EXIT_SUCCESS;
+}
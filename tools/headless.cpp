@@ -0,0 +1,514 @@
+#include "game_of_life.hpp"
+#include "life_kernel.hpp"
+#include "pattern_io.hpp"
+#include "checkpoint.hpp"
+#include "hash_life.hpp"
+#include "sparse_life.hpp"
+#include "rule.hpp"
+#include "timing.hpp"
+#include "trace.hpp"
+#include "log.hpp"
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <stdexcept>
+#include <memory>
+
+// run the simulation without a window: load or generate the first
+// generation, calculate the generations and write the summary
+
+std::size_t WIDTH = 1024;
+std::size_t HEIGHT = 1024;
+std::size_t GENERATIONS = 1000;
+std::size_t THREADS = 0;
+std::size_t SEED = 1;
+double DENSITY = 0.3;
+bool IS_BOUNDED = false;
+std::string INPUT;
+std::string OUTPUT;
+nzs::gol::Rule RULE;
+nzs::gol::CheckpointPolicy AUTOSAVE;
+bool RESUME = false;
+bool UNTIL_STABLE = false;
+std::string TIMERS;
+std::string TRACE;
+// bitwise, reference, sparse or hashlife
+std::string ENGINE = "bitwise";
+
+template<class T>
+bool fetch_value(const std::string &text, T &value)
+{
+    std::istringstream convert(text);
+    T tmp;
+    if (!(convert >> tmp) || !convert.eof())
+    {
+        Log::warning("Invalid parameter value:", text);
+        return false;
+    }
+    value = tmp;
+    return true;
+}
+
+void parseCLA(int argc, const char *argv[])
+{
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    for (std::size_t i = 0; i < args.size(); ++i)
+    {
+        if (args[i] == "--help")
+        {
+            std::cout << "USAGE: " + std::string(argv[0])
+                      << " [-w|--width ARG] [-h|--height ARG] [-n|--generations ARG]"
+                      << " [-i|--input FILE] [-o|--output FILE] [-d|--density ARG] [-s|--seed ARG]"
+                      << " [-t|--threads ARG] [-b|--bounded] [--rule ARG]"
+                      << " [--autosave-generations ARG] [--autosave-seconds ARG] [--autosave-keep ARG]"
+                      << " [--autosave-prefix PATH] [--resume] [--until-stable] [--timers FILE] [--trace FILE]"
+                      << " [-e|--engine bitwise|reference|sparse|hashlife] [-j|--jump ARG] [--help]" << std::endl;
+
+            std::cout << std::endl << "Option Descriptions" << std::endl << std::endl;
+
+            std::cout << std::left;
+            std::cout << std::setw(15) << "\t-w [ --width ]"       << "\t\t" << "Set the number of columns." << std::endl;
+            std::cout << std::setw(15) << "\t-h [ --height ]"      << "\t\t" << "Set the number of rows." << std::endl;
+            std::cout << std::setw(15) << "\t-n [ --generations ]" << "\t"   << "Set the number of generations to calculate." << std::endl;
+            std::cout << std::setw(15) << "\t-i [ --input ]"       << "\t\t" << "Load the first generation from an RLE (.rle), macrocell (.mc), checkpoint (.gol) or plaintext file." << std::endl;
+            std::cout << std::setw(15) << "\t-o [ --output ]"      << "\t\t" << "Write the last generation to an RLE (.rle), macrocell (.mc), checkpoint (.gol) or plaintext file." << std::endl;
+            std::cout << std::setw(15) << "\t-d [ --density ]"     << "\t" << "Set the density of the random first generation (without input)." << std::endl;
+            std::cout << std::setw(15) << "\t-s [ --seed ]"        << "\t\t" << "Set the seed of the random first generation." << std::endl;
+            std::cout << std::setw(15) << "\t-t [ --threads ]"     << "\t" << "Set the number of stepping threads (0 = one per core)." << std::endl;
+            std::cout << std::setw(15) << "\t-b [ --bounded ]"     << "\t" << "Treat the cells outside of the grid as dead instead of wrapping." << std::endl;
+            std::cout << std::setw(15) << "\t--rule"              << "\t\t" << "Set the rule in B/S notation (default B3/S23)." << std::endl;
+            std::cout << std::setw(15) << "\t--autosave-generations" << "\t" << "Write a checkpoint after this many generations (0 = never)." << std::endl;
+            std::cout << std::setw(15) << "\t--autosave-seconds" << "\t" << "Write a checkpoint after this many seconds (0 = never)." << std::endl;
+            std::cout << std::setw(15) << "\t--autosave-keep"    << "\t" << "Keep the last this many checkpoints (default 3)." << std::endl;
+            std::cout << std::setw(15) << "\t--autosave-prefix"  << "\t" << "Write the checkpoints to PATH.<slot>.gol (default ./autosave)." << std::endl;
+            std::cout << std::setw(15) << "\t--resume"          << "\t\t" << "Continue from the newest checkpoint of the autosave prefix." << std::endl;
+            std::cout << std::setw(15) << "\t--until-stable"    << "\t" << "Stop before the generation limit once the board is static or periodic." << std::endl;
+            std::cout << std::setw(15) << "\t-e [ --engine ]"     << "\t" << "Step with bitwise (default), reference, sparse (unbounded plane) or hashlife (B3/S23 on an unbounded plane)." << std::endl;
+            std::cout << std::setw(15) << "\t-j [ --jump ]"       << "\t\t" << "Calculate 2^ARG generations instead of --generations." << std::endl;
+            std::cout << std::setw(15) << "\t--timers"          << "\t\t" << "Write the times of the generations to a JSON file at the exit." << std::endl;
+            std::cout << std::setw(15) << "\t--trace"           << "\t\t" << "Write the generations and the tile rows to a Chrome trace (JSON) file at the exit." << std::endl;
+            std::cout << std::setw(15) << "\t--help"              << "\t\t" << "Print this message and exit." << std::endl;
+            std::exit(EXIT_SUCCESS);
+        }
+        // && ++i < args.size() = next argument is exist?
+        else if ((args[i] == "-w" || args[i] == "--width") && ++i < args.size())
+        {
+            fetch_value(args[i], WIDTH);
+        }
+        else if ((args[i] == "-h" || args[i] == "--height") && ++i < args.size())
+        {
+            fetch_value(args[i], HEIGHT);
+        }
+        else if ((args[i] == "-n" || args[i] == "--generations") && ++i < args.size())
+        {
+            fetch_value(args[i], GENERATIONS);
+        }
+        else if ((args[i] == "-i" || args[i] == "--input") && ++i < args.size())
+        {
+            INPUT = args[i];
+        }
+        else if ((args[i] == "-o" || args[i] == "--output") && ++i < args.size())
+        {
+            OUTPUT = args[i];
+        }
+        else if ((args[i] == "-d" || args[i] == "--density") && ++i < args.size())
+        {
+            fetch_value(args[i], DENSITY);
+        }
+        else if ((args[i] == "-s" || args[i] == "--seed") && ++i < args.size())
+        {
+            fetch_value(args[i], SEED);
+        }
+        else if ((args[i] == "-t" || args[i] == "--threads") && ++i < args.size())
+        {
+            fetch_value(args[i], THREADS);
+        }
+        else if (args[i] == "-b" || args[i] == "--bounded")
+        {
+            IS_BOUNDED = true;
+        }
+        else if (args[i] == "--rule" && ++i < args.size())
+        {
+            try
+            {
+                RULE = nzs::gol::Rule::parse(args[i]);
+            }
+            catch (const std::invalid_argument &)
+            {
+                Log::warning("Invalid rule:", args[i]);
+            }
+        }
+        else if (args[i] == "--autosave-generations" && ++i < args.size())
+        {
+            fetch_value(args[i], AUTOSAVE.generations);
+        }
+        else if (args[i] == "--autosave-seconds" && ++i < args.size())
+        {
+            std::size_t seconds = 0;
+            if (fetch_value(args[i], seconds))
+            {
+                AUTOSAVE.seconds = std::chrono::seconds(seconds);
+            }
+        }
+        else if (args[i] == "--autosave-keep" && ++i < args.size())
+        {
+            fetch_value(args[i], AUTOSAVE.keep);
+        }
+        else if (args[i] == "--autosave-prefix" && ++i < args.size())
+        {
+            AUTOSAVE.prefix = args[i];
+        }
+        else if (args[i] == "--resume")
+        {
+            RESUME = true;
+        }
+        else if (args[i] == "--until-stable")
+        {
+            UNTIL_STABLE = true;
+        }
+        else if (args[i] == "--timers" && ++i < args.size())
+        {
+            TIMERS = args[i];
+        }
+        else if (args[i] == "--trace" && ++i < args.size())
+        {
+            TRACE = args[i];
+        }
+        else if ((args[i] == "-e" || args[i] == "--engine") && ++i < args.size())
+        {
+            if (args[i] == "bitwise" || args[i] == "reference" || args[i] == "sparse" ||
+                    args[i] == "hashlife")
+            {
+                ENGINE = args[i];
+            }
+            else
+            {
+                Log::warning("Invalid engine:", args[i]);
+            }
+        }
+        else if ((args[i] == "-j" || args[i] == "--jump") && ++i < args.size())
+        {
+            std::size_t power = 0;
+            if (fetch_value(args[i], power) && power < 64)
+            {
+                GENERATIONS = std::size_t(1) << power;
+            }
+            else
+            {
+                Log::warning("Invalid jump:", args[i]);
+            }
+        }
+        else
+        {
+            Log::warning("Invalid parameter:", args[i]);
+        }
+    }
+}
+
+bool is_macrocell(const std::string &file_path)
+{
+    return file_path.size() >= 3 && file_path.compare(file_path.size() - 3, 3, ".mc") == 0;
+}
+
+// the first generation from the input file or the random one
+bool make_board(nzs::gol::GameOfLife &game)
+{
+    game.set_threads(THREADS);
+    game.set_rule(RULE);
+    if (IS_BOUNDED)
+    {
+        game.toggle_boundary();
+    }
+
+    if (!INPUT.empty())
+    {
+        // the grid grows to the pattern and the rule of an RLE file is used
+        return nzs::gol::load_board(INPUT, game);
+    }
+
+    std::mt19937_64 random(SEED);
+    std::bernoulli_distribution alive(DENSITY);
+    for (std::size_t y = 0; y < HEIGHT; ++y)
+    {
+        for (std::size_t x = 0; x < WIDTH; ++x)
+        {
+            if (alive(random))
+            {
+                game.born({static_cast<int>(x), static_cast<int>(y)});
+            }
+        }
+    }
+    return true;
+}
+
+// HashLife on the unbounded plane: the generations are taken in power of two
+// jumps, so billions of generations of a regular pattern take seconds; the
+// macrocell files are loaded without a grid, so they can be of any size
+int run_hashlife()
+{
+    nzs::gol::HashLife life;
+    if (is_macrocell(INPUT))
+    {
+        if (!nzs::gol::load_macrocell(INPUT, life))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        nzs::gol::GameOfLife game {WIDTH, HEIGHT};
+        if (!make_board(game))
+        {
+            return EXIT_FAILURE;
+        }
+        if (!nzs::gol::HashLife::supports(game.get_rule()))
+        {
+            Log::error("HashLife calculates B3/S23 only, not", game.get_rule().to_string());
+            return EXIT_FAILURE;
+        }
+        // the middle of the grid goes to (0, 0)
+        const nzs::gol::BitGrid &grid = game.grid();
+        life.set_cells(grid, {-static_cast<std::int64_t>(grid.get_width() / 2),
+                              -static_cast<std::int64_t>(grid.get_height() / 2)});
+        life.set_generation(game.generation());
+    }
+    if (AUTOSAVE.enabled() || UNTIL_STABLE)
+    {
+        Log::warning("the autosave and --until-stable are not supported by HashLife");
+    }
+    if (!OUTPUT.empty() && !is_macrocell(OUTPUT))
+    {
+        Log::error("HashLife writes macrocell (.mc) files only:", OUTPUT);
+        return EXIT_FAILURE;
+    }
+
+    nzs::gol::set_timing(!TIMERS.empty());
+    nzs::gol::set_tracing(!TRACE.empty());
+    nzs::gol::set_thread_name("main");
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t first_generation = life.generation();
+    try
+    {
+        life.next(GENERATIONS);
+    }
+    catch (const std::exception &error)
+    {
+        Log::error("HashLife stopped at generation", life.generation(), ":", error.what());
+        return EXIT_FAILURE;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double seconds = elapsed.count();
+    std::uint64_t generations = life.generation() - first_generation;
+    std::cout << "engine: hashlife\n"
+              << "rule: B3/S23\n"
+              << "generations: " << life.generation() << "\n"
+              << "population: " << life.population() << "\n"
+              << "nodes: " << life.node_count() << "\n"
+              << "time: " << seconds << " s\n"
+              << "generations/s: " << (seconds > 0 ? generations / seconds : 0) << std::endl;
+
+    if (!OUTPUT.empty() && !nzs::gol::save_macrocell(OUTPUT, life))
+    {
+        return EXIT_FAILURE;
+    }
+    if (!TIMERS.empty() && !nzs::gol::write_timers(TIMERS))
+    {
+        Log::error("cannot write file:", TIMERS);
+        return EXIT_FAILURE;
+    }
+    if (!TRACE.empty() && !nzs::gol::write_trace(TRACE))
+    {
+        Log::error("cannot write file:", TRACE);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+int run_sparse()
+{
+    nzs::gol::GameOfLife game {WIDTH, HEIGHT};
+    if (!make_board(game))
+    {
+        return EXIT_FAILURE;
+    }
+    if (!nzs::gol::SparseLife::supports(game.get_rule()))
+    {
+        Log::error("the sparse engine does not calculate the B0 rules:", game.get_rule().to_string());
+        return EXIT_FAILURE;
+    }
+    if (AUTOSAVE.enabled() || UNTIL_STABLE)
+    {
+        Log::warning("the autosave and --until-stable are not supported by the sparse engine");
+    }
+
+    nzs::gol::SparseLife life;
+    life.set_rule(game.get_rule());
+    life.set_cells(game.grid(), {0, 0});
+
+    nzs::gol::set_timing(!TIMERS.empty());
+    nzs::gol::set_tracing(!TRACE.empty());
+    nzs::gol::set_thread_name("main");
+    auto start = std::chrono::steady_clock::now();
+    life.next(GENERATIONS);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double seconds = elapsed.count();
+    std::cout << "engine: sparse\n"
+              << "rule: " << life.get_rule().to_string() << "\n"
+              << "generations: " << game.generation() + life.generation() << "\n"
+              << "population: " << life.population() << "\n"
+              << "tiles: " << life.tile_count() << "\n"
+              << "time: " << seconds << " s\n"
+              << "generations/s: " << (seconds > 0 ? life.generation() / seconds : 0) << std::endl;
+
+    if (!OUTPUT.empty())
+    {
+        // the plane is written in the size of the board, the cells outside are lost
+        std::vector<nzs::gol::Position64> cells;
+        life.get_cells(cells);
+        std::size_t outside = 0;
+        nzs::gol::BitGrid grid(WIDTH, HEIGHT);
+        for (const auto &cell : cells)
+        {
+            if (cell.get_x() < 0 || cell.get_y() < 0 ||
+                    cell.get_x() >= static_cast<std::int64_t>(WIDTH) ||
+                    cell.get_y() >= static_cast<std::int64_t>(HEIGHT))
+            {
+                ++outside;
+                continue;
+            }
+            grid.set(static_cast<std::size_t>(cell.get_x()), static_cast<std::size_t>(cell.get_y()), true);
+        }
+        game.restore(grid, game.generation() + life.generation());
+        if (outside != 0)
+        {
+            Log::warning(outside, "cells are outside of the board and not written");
+        }
+        if (!nzs::gol::save_pattern(OUTPUT, game))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    if (!TIMERS.empty() && !nzs::gol::write_timers(TIMERS))
+    {
+        Log::error("cannot write file:", TIMERS);
+        return EXIT_FAILURE;
+    }
+    if (!TRACE.empty() && !nzs::gol::write_trace(TRACE))
+    {
+        Log::error("cannot write file:", TRACE);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char const *argv[])
+{
+    Log::init(argc, argv);
+    parseCLA(argc, argv);
+
+    if (RESUME)
+    {
+        INPUT = nzs::gol::latest_checkpoint(AUTOSAVE);
+        if (INPUT.empty())
+        {
+            Log::error("no checkpoint to resume:", AUTOSAVE.prefix);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (ENGINE == "hashlife")
+    {
+        return run_hashlife();
+    }
+    if (ENGINE == "sparse")
+    {
+        return run_sparse();
+    }
+
+    nzs::gol::GameOfLife game {WIDTH, HEIGHT, ENGINE == "reference" ? nzs::gol::Engine::reference
+                               : nzs::gol::Engine::bitwise};
+    if (!make_board(game))
+    {
+        return EXIT_FAILURE;
+    }
+
+    NZS_LOG_DEBUG("stepping kernel:", nzs::gol::details::simd_name(nzs::gol::details::simd()),
+                  "threads:", game.get_threads(), "rule:", game.get_rule().to_string());
+
+    nzs::gol::set_timing(!TIMERS.empty());
+    nzs::gol::set_tracing(!TRACE.empty());
+    nzs::gol::set_thread_name("main");
+    auto start = std::chrono::steady_clock::now();
+    std::size_t first_generation = game.generation();
+    // the work of every next() call, summed over the run
+    nzs::gol::StepStats stats = {0, 0};
+    // one generation per call, so the timers see every generation
+    if (AUTOSAVE.enabled() || UNTIL_STABLE || !TIMERS.empty())
+    {
+        // the checkpoints are written on an other thread between the generations
+        std::unique_ptr<nzs::gol::AutoCheckpoint> autosave;
+        if (AUTOSAVE.enabled())
+        {
+            autosave.reset(new nzs::gol::AutoCheckpoint(AUTOSAVE));
+            autosave->update(game);
+        }
+        for (std::size_t i = 0; i < GENERATIONS; ++i)
+        {
+            game.next();
+            stats.tiles += game.stats().tiles;
+            stats.stepped_tiles += game.stats().stepped_tiles;
+            if (autosave)
+            {
+                autosave->update(game);
+            }
+            if (UNTIL_STABLE && game.period() != 0)
+            {
+                break;
+            }
+        }
+    }
+    else
+    {
+        game.next(GENERATIONS);
+        stats = game.stats();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double seconds = elapsed.count();
+    std::size_t generations = game.generation() - first_generation;
+    double cells = static_cast<double>(game.get_width()) * game.get_height() * generations;
+    std::cout << "grid: " << game.get_width() << "x" << game.get_height() << "\n"
+              << "rule: " << game.get_rule().to_string() << "\n"
+              << "generations: " << game.generation() << "\n"
+              << "population: " << game.population() << "\n"
+              << "period: " << game.period() << "\n"
+              << "hash: " << std::hex << game.hash() << std::dec << "\n"
+              << "skip ratio: " << stats.skip_ratio() << "\n"
+              << "time: " << seconds << " s\n"
+              << "generations/s: " << (seconds > 0 ? generations / seconds : 0) << "\n"
+              << "cells/s: " << (seconds > 0 ? cells / seconds : 0) << std::endl;
+
+    if (!OUTPUT.empty() && !nzs::gol::save_pattern(OUTPUT, game))
+    {
+        return EXIT_FAILURE;
+    }
+    if (!TIMERS.empty() && !nzs::gol::write_timers(TIMERS))
+    {
+        Log::error("cannot write file:", TIMERS);
+        return EXIT_FAILURE;
+    }
+    if (!TRACE.empty() && !nzs::gol::write_trace(TRACE))
+    {
+        Log::error("cannot write file:", TRACE);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,320 @@
+#include "game_of_life.hpp"
+#include "soup_search.hpp"
+#include "census.hpp"
+#include "pattern_io.hpp"
+#include "rule.hpp"
+#include "log.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+
+// run many random soups until they stabilize and write the lifespan, the final
+// population, the period and the objects of every soup, a soup is reproduced by its seed
+
+std::uint64_t COUNT = 10000;
+std::uint64_t SEED = 1;
+std::size_t THREADS = 0;
+nzs::gol::SoupOptions OPTIONS;
+std::string OUTPUT;
+std::string PATTERN;
+std::string BRUSHS = "./brushs.txt";
+
+// the results of a worker thread, merged at the end
+struct Summary
+{
+    Summary() :
+        soups(0),
+        stable(0),
+        lifespan(0),
+        population(0),
+        longest{0, 0, 0, 0, {{}, 0}}
+    {
+    }
+
+    std::uint64_t soups;
+    std::uint64_t stable;
+    // sums for the averages
+    double lifespan;
+    double population;
+    nzs::gol::SoupResult longest;
+    std::map<std::size_t, std::uint64_t> periods;
+    // the objects of the final boards by name
+    std::map<std::string, std::uint64_t> objects;
+    // the lines of the output which are not written yet
+    std::string lines;
+};
+
+template<class T>
+bool fetch_value(const std::string &text, T &value)
+{
+    std::istringstream convert(text);
+    T tmp;
+    if (!(convert >> tmp) || !convert.eof())
+    {
+        Log::warning("Invalid parameter value:", text);
+        return false;
+    }
+    value = tmp;
+    return true;
+}
+
+void parseCLA(int argc, const char *argv[])
+{
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    for (std::size_t i = 0; i < args.size(); ++i)
+    {
+        if (args[i] == "--help")
+        {
+            std::cout << "USAGE: " + std::string(argv[0])
+                      << " [-n|--count ARG] [-s|--seed ARG] [-t|--threads ARG] [-w|--width ARG]"
+                      << " [-h|--height ARG] [--soup-size ARG] [-d|--density ARG] [-m|--max-generations ARG]"
+                      << " [--wrap] [--rule ARG] [-b|--brushs FILE] [-o|--output FILE] [-p|--pattern FILE] [--help]" << std::endl;
+
+            std::cout << std::endl << "Option Descriptions" << std::endl << std::endl;
+
+            std::cout << std::left;
+            std::cout << std::setw(15) << "\t-n [ --count ]"    << "\t\t" << "Set the number of soups." << std::endl;
+            std::cout << std::setw(15) << "\t-s [ --seed ]"     << "\t\t" << "Set the seed of the first soup, the next soups use the next seeds." << std::endl;
+            std::cout << std::setw(15) << "\t-t [ --threads ]"  << "\t" << "Set the number of threads (0 = one per core)." << std::endl;
+            std::cout << std::setw(15) << "\t-w [ --width ]"    << "\t\t" << "Set the number of columns of the board." << std::endl;
+            std::cout << std::setw(15) << "\t-h [ --height ]"   << "\t\t" << "Set the number of rows of the board." << std::endl;
+            std::cout << std::setw(15) << "\t--soup-size"       << "\t\t" << "Set the size of the random square in the middle of the board." << std::endl;
+            std::cout << std::setw(15) << "\t-d [ --density ]"  << "\t" << "Set the density of the soups." << std::endl;
+            std::cout << std::setw(15) << "\t-m [ --max-generations ]" << "\t" << "Give up the soups which do not stabilize until this generation." << std::endl;
+            std::cout << std::setw(15) << "\t--wrap"            << "\t\t" << "Wrap around the border instead of treating the cells outside as dead." << std::endl;
+            std::cout << std::setw(15) << "\t--rule"            << "\t\t" << "Set the rule in B/S notation (default B3/S23)." << std::endl;
+            std::cout << std::setw(15) << "\t-b [ --brushs ]"   << "\t\t" << "Name the objects of the final boards by the patterns of this brush file." << std::endl;
+            std::cout << std::setw(15) << "\t-o [ --output ]"   << "\t\t" << "Write seed,lifespan,population,period,census of every soup to a CSV file." << std::endl;
+            std::cout << std::setw(15) << "\t-p [ --pattern ]"  << "\t" << "Write the longest lived soup to a pattern file." << std::endl;
+            std::cout << std::setw(15) << "\t--help"            << "\t\t" << "Print this message and exit." << std::endl;
+            std::exit(EXIT_SUCCESS);
+        }
+        // && ++i < args.size() = next argument is exist?
+        else if ((args[i] == "-n" || args[i] == "--count") && ++i < args.size())
+        {
+            fetch_value(args[i], COUNT);
+        }
+        else if ((args[i] == "-s" || args[i] == "--seed") && ++i < args.size())
+        {
+            fetch_value(args[i], SEED);
+        }
+        else if ((args[i] == "-t" || args[i] == "--threads") && ++i < args.size())
+        {
+            fetch_value(args[i], THREADS);
+        }
+        else if ((args[i] == "-w" || args[i] == "--width") && ++i < args.size())
+        {
+            fetch_value(args[i], OPTIONS.width);
+        }
+        else if ((args[i] == "-h" || args[i] == "--height") && ++i < args.size())
+        {
+            fetch_value(args[i], OPTIONS.height);
+        }
+        else if (args[i] == "--soup-size" && ++i < args.size())
+        {
+            fetch_value(args[i], OPTIONS.soup_size);
+        }
+        else if ((args[i] == "-d" || args[i] == "--density") && ++i < args.size())
+        {
+            fetch_value(args[i], OPTIONS.density);
+        }
+        else if ((args[i] == "-m" || args[i] == "--max-generations") && ++i < args.size())
+        {
+            fetch_value(args[i], OPTIONS.max_generations);
+        }
+        else if (args[i] == "--wrap")
+        {
+            OPTIONS.bounded = false;
+        }
+        else if (args[i] == "--rule" && ++i < args.size())
+        {
+            try
+            {
+                OPTIONS.rule = nzs::gol::Rule::parse(args[i]);
+            }
+            catch (const std::invalid_argument &)
+            {
+                Log::warning("Invalid rule:", args[i]);
+            }
+        }
+        else if ((args[i] == "-b" || args[i] == "--brushs") && ++i < args.size())
+        {
+            BRUSHS = args[i];
+        }
+        else if ((args[i] == "-o" || args[i] == "--output") && ++i < args.size())
+        {
+            OUTPUT = args[i];
+        }
+        else if ((args[i] == "-p" || args[i] == "--pattern") && ++i < args.size())
+        {
+            PATTERN = args[i];
+        }
+        else
+        {
+            Log::warning("Invalid parameter:", args[i]);
+        }
+    }
+}
+
+int main(int argc, char const *argv[])
+{
+    Log::init(argc, argv);
+    parseCLA(argc, argv);
+
+    // the census works without names too, the unknown objects are counted by their code
+    nzs::gol::ObjectLibrary library;
+    library.load_brushes(BRUSHS);
+    OPTIONS.library = &library;
+
+    std::ofstream output;
+    if (!OUTPUT.empty())
+    {
+        output.open(OUTPUT);
+        if (!output)
+        {
+            Log::error("cannot write the output:", OUTPUT);
+            return EXIT_FAILURE;
+        }
+        output << "seed,lifespan,population,period,census\n";
+    }
+    std::mutex output_mutex;
+    auto write_lines = [&](std::string &lines)
+    {
+        std::lock_guard<std::mutex> lock(output_mutex);
+        output << lines;
+        lines.clear();
+    };
+
+    std::size_t threads = THREADS == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : THREADS;
+    std::vector<Summary> summaries(threads);
+    Log::debug("soups:", COUNT, "first seed:", SEED, "threads:", threads,
+               "rule:", OPTIONS.rule.to_string());
+
+    // every thread has its own summary, only the output file is shared
+    auto report = [&](const nzs::gol::SoupResult & result, std::size_t thread)
+    {
+        Summary &summary = summaries[thread];
+        ++summary.soups;
+        summary.lifespan += result.lifespan;
+        summary.population += result.population;
+        ++summary.periods[result.period];
+        if (result.period != 0)
+        {
+            ++summary.stable;
+        }
+        for (const auto &entry : result.census.entries)
+        {
+            summary.objects[entry.name] += entry.count;
+        }
+        if (summary.soups == 1 || result.lifespan > summary.longest.lifespan)
+        {
+            summary.longest = result;
+        }
+
+        if (output.is_open())
+        {
+            summary.lines += std::to_string(result.seed) + ',' + std::to_string(result.lifespan) + ',' +
+                             std::to_string(result.population) + ',' + std::to_string(result.period) + ',';
+            for (std::size_t i = 0; i < result.census.entries.size(); ++i)
+            {
+                const auto &entry = result.census.entries[i];
+                summary.lines += (i == 0 ? "" : ";") + entry.name + '=' + std::to_string(entry.count);
+            }
+            summary.lines += '\n';
+            if (summary.lines.size() >= (1 << 16))
+            {
+                write_lines(summary.lines);
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    nzs::gol::search_soups(OPTIONS, SEED, COUNT, threads, report);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    Summary total;
+    for (auto &summary : summaries)
+    {
+        if (output.is_open())
+        {
+            write_lines(summary.lines);
+        }
+        if (summary.soups != 0 && (total.soups == 0 || summary.longest.lifespan > total.longest.lifespan))
+        {
+            total.longest = summary.longest;
+        }
+        total.soups += summary.soups;
+        total.stable += summary.stable;
+        total.lifespan += summary.lifespan;
+        total.population += summary.population;
+        for (const auto &period : summary.periods)
+        {
+            total.periods[period.first] += period.second;
+        }
+        for (const auto &object : summary.objects)
+        {
+            total.objects[object.first] += object.second;
+        }
+    }
+
+    double seconds = elapsed.count();
+    double soups = total.soups == 0 ? 1.0 : static_cast<double>(total.soups);
+    std::cout << "soups: " << total.soups << "\n"
+              << "stabilized: " << total.stable << "\n"
+              << "average lifespan: " << total.lifespan / soups << "\n"
+              << "average population: " << total.population / soups << "\n"
+              << "longest lifespan: " << total.longest.lifespan << " (seed " << total.longest.seed << ")\n";
+    for (const auto &period : total.periods)
+    {
+        if (period.first == 0)
+        {
+            continue;
+        }
+        std::cout << "period " << period.first << ": " << period.second << "\n";
+    }
+
+    // the most common objects first
+    std::vector<std::pair<std::uint64_t, std::string>> objects;
+    for (const auto &object : total.objects)
+    {
+        objects.push_back({object.second, object.first});
+    }
+    std::sort(objects.begin(), objects.end(), [](const std::pair<std::uint64_t, std::string> & a,
+                                                 const std::pair<std::uint64_t, std::string> & b)
+    {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    for (std::size_t i = 0; i < objects.size() && i < 20; ++i)
+    {
+        std::cout << objects[i].second << ": " << objects[i].first << "\n";
+    }
+    std::cout << "time: " << seconds << " s\n"
+              << "soups/s: " << (seconds > 0 ? total.soups / seconds : 0) << std::endl;
+
+    if (!PATTERN.empty() && total.soups != 0)
+    {
+        nzs::gol::GameOfLife game(OPTIONS.width, OPTIONS.height);
+        nzs::gol::make_soup(game, OPTIONS, total.longest.seed);
+        if (!nzs::gol::save_pattern(PATTERN, game))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    if (output.is_open() && !output)
+    {
+        Log::error("cannot write the output:", OUTPUT);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}